@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "topology.h"
 #include "gameworld.h"
+#include "benchmark.h"
 
 #include <iostream>
 #include <chrono>
@@ -64,45 +65,51 @@ int _tmain(int argc, _TCHAR* argv[])
 //	--------------------------------------------------------
 
 /*
-void RenderDelaunay(QuadList& quads, EdgeList& mst)
+void RenderDelaunay(Delaunay& del)
 {
 	// Build the remdering environment
 	sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Delaunay Triangulator");
+	window.setFramerateLimit(60);
+
+	Overlay overlay;
+	overlay.setVisible(DELAUNAY_LAYER, DRAW_DELAUNAY);
+	overlay.setVisible(VORONOI_LAYER, DRAW_VORONOI);
+	overlay.setVisible(MST_LAYER, DRAW_MST);
 
-	// Turn the vertices into something we want to render
-	std::vector<std::tuple<sf::Vector2f, sf::Vector2f>> quads_debug;
-	for (int i = 0; i < quads.size(); i++)
+	// Rendering loop
+	while (window.isOpen())
 	{
-		sf::Vector2f a(quads[i]->edges[0].origin()->x(), quads[i]->edges[0].origin()->y());
-		sf::Vector2f b(quads[i]->edges[2].origin()->x(), quads[i]->edges[2].origin()->y());
-		quads_debug.push_back(std::make_tuple(a, b));
-		//quads_debug.push_back(std::make_tuple(quads[i]->edges[1].origin()->getPosition(), quads[i]->edges[3].origin()->getPosition()));
+		window.clear();
+
+		// Nothing gets refilled unless the triangulation changed since last frame
+		overlay.Update(del);
+		overlay.Draw(window);
+
+		window.display();
 	}
+}
+
+void DriftDebug(int n)
+{
+	// Watch the rooms push each other apart, one step a frame
+	sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Drifting rooms");
+	window.setFramerateLimit(60);
+
+	Dungeon dungeon;
+	dungeon.ScatterRooms(n);
+
+	Overlay overlay(true);
+	overlay.setVisible(ROOM_LAYER, true);
 
-	// Rendering loop
 	while (window.isOpen())
 	{
 		window.clear();
 
-		for (auto i = quads.begin(); i != quads.end(); ++i)
-		{
-			if (DRAW_DELAUNAY && (*i)->edges[0].draw)
-			{
-				DrawEdge((*i)->edges, window, sf::Color::White);
-			}
-			if (DRAW_VORONOI && (*i)->edges[1].draw)
-			{
-				DrawVoronoi((*i)->edges, window);
-			}
-		}
-
-		for (auto i = mst.begin(); i != mst.end(); ++i)
-		{
-			if (DRAW_MST && (*i)->draw)
-			{
-				DrawEdge((*i), window, sf::Color::Red);
-			}
-		}
+		dungeon.DriftStep();
+		overlay.Update(dungeon);
+		overlay.Draw(window);
+
+		window.display();
 	}
 }
 
@@ -138,12 +145,21 @@ void DelaunayDebug()
 	auto t1 = std::chrono::high_resolution_clock::now();
 	Delaunay del(n);
 	del.GetTriangulation();
-	QuadList quads = del.GetVoronoi();
-	EdgeList mst = del.GetMST();
+	del.GetVoronoi();
+	del.GetMST();
 	auto t2 = std::chrono::high_resolution_clock::now();
 
 	std::cout << "Running time (ms): " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << std::endl;
 
-	RenderDelaunay(quads, mst);
+	RenderDelaunay(del);
+}
+
+void BenchmarkDebug()
+{
+	// Vertical against alternating cuts; run it in Release or the numbers mean nothing
+	BenchmarkCuts(std::cout);
+
+	// Grids, collinear runs and near-duplicates against uniform points, checked as well as timed
+	BenchmarkDegenerate(std::cout);
 }
 */
\ No newline at end of file
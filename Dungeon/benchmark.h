@@ -0,0 +1,370 @@
+//	--------------------------------------------------------
+//	BENCHMARK.H
+//	--------------------------------------------------------
+//	Contains timing harnesses for the triangulator
+//	None of this runs in the game; call it from main when you want numbers
+//	--------------------------------------------------------
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "topology.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+//	--------------------------------------------------------
+//	Point clouds
+//	--------------------------------------------------------
+
+typedef std::vector<std::vector<float>>					PointBuffer;
+
+// The triangulator wants its input sorted with no repeats
+inline void SortAndDedupe(PointBuffer& buffer)
+{
+	std::sort(buffer.begin(), buffer.end());
+	buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+}
+
+// Points scattered evenly over a square, which is roughly what room centroids look like
+inline PointBuffer UniformPoints(int n, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> coord(0.0f, 10000.0f);
+
+	PointBuffer buffer;
+	buffer.reserve(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		buffer.push_back({ coord(rng), coord(rng) });
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+// Points bunched up in a handful of gaussian blobs, which is what rooms look like before they've drifted apart
+inline PointBuffer ClusteredPoints(int n, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> center(0.0f, 10000.0f);
+	std::normal_distribution<float> spread(0.0f, 150.0f);
+
+	const int clusters = 16;
+	std::vector<float> cx(clusters);
+	std::vector<float> cy(clusters);
+
+	for (int c = 0; c < clusters; c++)
+	{
+		cx[c] = center(rng);
+		cy[c] = center(rng);
+	}
+
+	PointBuffer buffer;
+	buffer.reserve(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		int c = rng() % clusters;
+		buffer.push_back({ cx[c] + spread(rng), cy[c] + spread(rng) });
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+//	--------------------------------------------------------
+//	Degenerate clouds
+//	--------------------------------------------------------
+
+// Each of these breaks general position on purpose; the triangulation should come out just as valid, and about as fast, as on UniformPoints
+
+// A square lattice, which is what rooms snapped to the tile grid look like; every little square is four points on one circle
+inline PointBuffer GridPoints(int n, float spacing)
+{
+	int side = std::max(1, (int)std::sqrt((double)n));
+
+	PointBuffer buffer;
+	buffer.reserve(side * side);
+
+	for (int i = 0; i < side; i++)
+	{
+		for (int j = 0; j < side; j++)
+		{
+			buffer.push_back({ i * spacing, j * spacing });
+		}
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+// Points strung along a few long lines, horizontal, vertical and diagonal, so whole subproblems come out flat
+inline PointBuffer CollinearPoints(int n, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> coord(0.0f, 10000.0f);
+
+	const int lines = 8;
+
+	PointBuffer buffer;
+	buffer.reserve(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		int line = i % lines;
+		float along = coord(rng);
+		float across = (float)(line * 1250);
+
+		if (line % 3 == 0)
+		{
+			buffer.push_back({ along, across });
+		}
+		else if (line % 3 == 1)
+		{
+			buffer.push_back({ across, along });
+		}
+		else
+		{
+			buffer.push_back({ along, along + across - 5000.0f });
+		}
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+// Uniform points, each with a twin one float step away, so only the exact arithmetic can tell them apart
+inline PointBuffer NearDuplicatePoints(int n, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	std::uniform_real_distribution<float> coord(0.0f, 10000.0f);
+
+	PointBuffer buffer;
+	buffer.reserve(n);
+
+	for (int i = 0; i + 1 < n; i += 2)
+	{
+		float x = coord(rng);
+		float y = coord(rng);
+		buffer.push_back({ x, y });
+		buffer.push_back({ std::nextafter(x, 20000.0f), ((i / 2) % 2 == 0) ? y : std::nextafter(y, 20000.0f) });
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+// Centers of rooms on the tile grid, sized the way the dungeon sizes them, so they land on whole and half tiles
+inline PointBuffer SnappedRoomPoints(int n, unsigned seed)
+{
+	std::mt19937 rng(seed);
+	int extent = std::max(16, (int)std::sqrt((double)n) * 8);
+	std::uniform_int_distribution<int> corner(0, extent);
+	std::uniform_int_distribution<int> size(3, 12);
+
+	PointBuffer buffer;
+	buffer.reserve(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		float left = (float)corner(rng);
+		float top = (float)corner(rng);
+		buffer.push_back({ left + size(rng) * 0.5f, top + size(rng) * 0.5f });
+	}
+
+	SortAndDedupe(buffer);
+	return buffer;
+}
+
+//	--------------------------------------------------------
+//	Checking
+//	--------------------------------------------------------
+
+// Counts what's wrong with a finished triangulation: triangles wound backward, edges that fail the empty-circle test,
+// and an edge count other than 3n - 3 - h (n - 1 if it's flat)
+// Ties count as failures too, so this only passes if the tie-breaking was applied the same way everywhere
+inline std::size_t CountDefects(Delaunay& del)
+{
+	EdgeList list = del.GetTriangulation();
+
+	TriangulationExport out;
+	del.Export(out);
+
+	const Delaunay::MeshType& mesh = del.mesh();
+	std::size_t defects = 0;
+	std::size_t edges = out.neighbors.size() / 2;
+
+	for (std::size_t t = 0; t < out.triangles.size(); t += 3)
+	{
+		if (!CCW(mesh.vert(out.triangles[t]), mesh.vert(out.triangles[t + 1]), mesh.vert(out.triangles[t + 2])))
+		{
+			defects++;
+		}
+	}
+
+	// The export has a slot for everything the mesh ever held, so only count the Verts something touches
+	std::size_t n = 0;
+	for (std::size_t v = 0; v + 1 < out.offsets.size(); v++)
+	{
+		n += (out.offsets[v] != out.offsets[v + 1]) ? 1 : 0;
+	}
+
+	std::size_t expected = out.triangles.empty() ? n - 1 : 3 * n - 3 - out.hull.size();
+	defects += (n > 1 && edges != expected) ? 1 : 0;
+
+	for (std::size_t i = 0; i < list.size(); i++)
+	{
+		// Only edges with a triangle on both sides have anything to check
+		EdgeRef e = list[i];
+		EdgeRef l = mesh.Lnext(e);
+		EdgeRef r = mesh.Lnext(Sym(e));
+
+		if (mesh.Lnext(mesh.Lnext(l)) != e || mesh.Lnext(mesh.Lnext(r)) != Sym(e))
+		{
+			continue;
+		}
+
+		const Vert& org = mesh.origin(e);
+		const Vert& dest = mesh.destination(e);
+		const Vert& left = mesh.destination(l);
+		const Vert& right = mesh.destination(r);
+
+		if (CCW(org, dest, left) && CCW(dest, org, right) && InCircle(org, dest, left, right))
+		{
+			defects++;
+		}
+	}
+
+	return defects;
+}
+
+// Every edge as a sorted pair of Verts, so two builds of the same buffer can be compared
+inline std::vector<std::pair<VertRef, VertRef>> EdgePairs(Delaunay& del)
+{
+	EdgeList list = del.GetTriangulation();
+
+	std::vector<std::pair<VertRef, VertRef>> pairs;
+	pairs.reserve(list.size());
+
+	for (std::size_t i = 0; i < list.size(); i++)
+	{
+		VertRef a = del.mesh().Org(list[i]);
+		VertRef b = del.mesh().Dest(list[i]);
+		pairs.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	return pairs;
+}
+
+//	--------------------------------------------------------
+//	Timing
+//	--------------------------------------------------------
+
+// Best of a few runs, in milliseconds; only the triangulation is timed, not loading the points
+inline double TimeTriangulation(PointBuffer& buffer, CutStrategy cuts, int runs, std::size_t& edges)
+{
+	double best = 0.0;
+
+	for (int r = 0; r < runs; r++)
+	{
+		Delaunay del(buffer);
+		del.setCuts(cuts);
+
+		auto t1 = std::chrono::steady_clock::now();
+		edges = del.GetTriangulation().size();
+		auto t2 = std::chrono::steady_clock::now();
+
+		double ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
+		best = (r == 0 || ms < best) ? ms : best;
+	}
+
+	return best;
+}
+
+// Vertical cuts against alternating cuts on the same clouds
+// The edge counts should always agree; if they don't, one of the modes is broken
+inline void BenchmarkCuts(std::ostream& out = std::cout, int runs = 3)
+{
+	const int sizes[] = { 1000, 10000, 100000, 1000000 };
+
+	out << std::setw(10) << "points" << std::setw(12) << "cloud" << std::setw(14) << "vertical ms" << std::setw(16) << "alternating ms" << std::setw(10) << "speedup" << std::setw(10) << "edges" << std::endl;
+
+	for (int s = 0; s < 4; s++)
+	{
+		for (int kind = 0; kind < 2; kind++)
+		{
+			PointBuffer buffer = (kind == 0) ? UniformPoints(sizes[s], sizes[s]) : ClusteredPoints(sizes[s], sizes[s]);
+
+			std::size_t vertical_edges = 0;
+			std::size_t alternating_edges = 0;
+			double vertical = TimeTriangulation(buffer, VERTICAL_CUTS, runs, vertical_edges);
+			double alternating = TimeTriangulation(buffer, ALTERNATING_CUTS, runs, alternating_edges);
+
+			out << std::setw(10) << buffer.size() << std::setw(12) << ((kind == 0) ? "uniform" : "clustered")
+				<< std::fixed << std::setprecision(2)
+				<< std::setw(14) << vertical << std::setw(16) << alternating << std::setw(10) << vertical / alternating
+				<< std::setw(10) << ((vertical_edges == alternating_edges) ? "match" : "MISMATCH") << std::endl;
+		}
+	}
+}
+
+// Each degenerate cloud against uniform points of the same size
+// Also checks the result, and that both cut strategies built exactly the same triangulation, which they only do if ties get broken
+inline void BenchmarkDegenerate(std::ostream& out = std::cout, int runs = 3)
+{
+	const int sizes[] = { 10000, 100000, 1000000 };
+	const char* names[] = { "uniform", "grid", "rooms", "collinear", "near-dupe" };
+
+	out << std::setw(10) << "points" << std::setw(12) << "cloud" << std::setw(10) << "ms" << std::setw(12) << "vs uniform" << std::setw(10) << "defects" << std::setw(12) << "canonical" << std::endl;
+
+	for (int s = 0; s < 3; s++)
+	{
+		double uniform = 0.0;
+
+		for (int kind = 0; kind < 5; kind++)
+		{
+			PointBuffer buffer;
+			switch (kind)
+			{
+			case 0: buffer = UniformPoints(sizes[s], sizes[s]); break;
+			case 1: buffer = GridPoints(sizes[s], 16.0f); break;
+			case 2: buffer = SnappedRoomPoints(sizes[s], sizes[s]); break;
+			case 3: buffer = CollinearPoints(sizes[s], sizes[s]); break;
+			default: buffer = NearDuplicatePoints(sizes[s], sizes[s]); break;
+			}
+
+			std::size_t edges = 0;
+			double ms = TimeTriangulation(buffer, VERTICAL_CUTS, runs, edges);
+			uniform = (kind == 0) ? ms : uniform;
+
+			Delaunay vertical(buffer);
+			Delaunay alternating(buffer);
+			alternating.setCuts(ALTERNATING_CUTS);
+
+			std::size_t defects = CountDefects(vertical);
+			bool canonical = (EdgePairs(vertical) == EdgePairs(alternating));
+
+			out << std::setw(10) << buffer.size() << std::setw(12) << names[kind]
+				<< std::fixed << std::setprecision(2)
+				<< std::setw(10) << ms << std::setw(12) << ms / uniform << std::setw(10) << defects
+				<< std::setw(12) << (canonical ? "yes" : "NO") << std::endl;
+		}
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
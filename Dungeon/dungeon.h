@@ -12,10 +12,14 @@
 //	--------------------------------------------------------
 
 #include "edge.h"
+#include "grid.h"
+#include "locator.h"
 #include "topology.h"
 #include "rng.h"
+#include "spawn.h"
 
 #include <cmath>
+#include <memory>
 #include <unordered_set>
 #include <iostream>
 
@@ -37,6 +41,47 @@ Corridor::Corridor(int a, int b, int c, int d, bool _horizontal) : Rect(a, b, c,
 
 }
 
+//	--------------------------------------------------------
+//	Which edges become corridors
+//	--------------------------------------------------------
+
+// The spanning tree always gets built, so every room is reachable
+// The other modes add some of the Gabriel or relative-neighborhood edges on top of it, which makes loops
+// Relative neighborhood edges are the sparser and shorter of the two, so those loops stay local
+enum CorridorMode
+{
+	TREE_CORRIDORS,
+	GABRIEL_CORRIDORS,
+	RNG_CORRIDORS
+};
+
+//	--------------------------------------------------------
+//	How the drift finds overlaps
+//	--------------------------------------------------------
+
+// Grid only checks rooms that share a cell of a grid that gets rebuilt every step
+// Kinetic keeps a triangulation of the room centers and moves its Verts along with the rooms, which is mostly edge flips,
+// then only checks rooms whose centers are close enough to overlap; when the drift settles the graph goes straight to the corridors
+// Both find the same overlaps, so the rooms end up in the same places either way
+enum DriftMode
+{
+	GRID_DRIFT,
+	KINETIC_DRIFT
+};
+
+//	--------------------------------------------------------
+//	Where the rooms start out
+//	--------------------------------------------------------
+
+// Circle drops every room on the same small circle, so nearly all of them start out overlapping and the drift does all the work,
+// and rooms that land in exactly the same spot with the same size end up as one room
+// Poisson spreads them over a disk sized for how many there are, mostly not touching, so the drift only has a few passes to do
+enum SpawnMode
+{
+	CIRCLE_SPAWN,
+	POISSON_SPAWN
+};
+
 //	--------------------------------------------------------
 //	Class for generating rooms and migrating them
 //	--------------------------------------------------------
@@ -52,6 +97,14 @@ private:
 	// And an RNG
 	DungeonRNG								rng_;
 
+	// How to pick corridors, and what fraction of the edges that aren't in the tree to add back
+	CorridorMode							corridorMode_;
+	float									loops_;
+
+	// How to look for overlapping rooms while they drift, and where they start
+	DriftMode								driftMode_;
+	SpawnMode								spawnMode_;
+
 	// We track the center of mass
 	// Not sure why this is important
 	float									centerX_;
@@ -63,16 +116,89 @@ private:
 	int left_;
 	int right_;
 
+	// The final rooms in a list, plus a triangulation of their centers for finding the closest one
+	// Shared so copies of the dungeon can keep asking
+	std::vector<Rect>						roomList_;
+	std::shared_ptr<IntDelaunay>			roomGraph_;
+	std::shared_ptr<IntLocator>				roomLocator_;
+
+	// Goes up whenever the rooms move or change, so anyone drawing them knows when to redo their copy
+	std::uint32_t							version_;
+
+	// The rooms while they drift, numbered when the drift starts; a room keeps its number until the drift is over
+	// Pushes add up in place, then turn into this step's velocity, which is a tile or nothing each way
+	// Everything's sized once up front, so a step doesn't allocate, look anything up in a tree or hash anything
+	RectArrays								drift_;
+	std::vector<int>						pushX_;
+	std::vector<int>						pushY_;
+	std::vector<int>						velocityX_;
+	std::vector<int>						velocityY_;
+	bool									drifting_;
+
+	// The grid drift only checks rooms that share a cell of this
+	RoomGrid								grid_;
+
+	// The grid drift reads the positions in drift_ and writes where everyone goes next into these, then swaps them in at the end of the step,
+	// so the rooms can be split into bands and handed out to threads without anybody seeing a room halfway through its move
+	// Each band keeps its own scratch, whether it saw an overlap, and the bounds of its rooms before they moved
+	struct DriftBand
+	{
+		std::uint32_t						first;
+		std::uint32_t						last;
+		std::vector<std::uint32_t>			hits;
+		std::vector<int>					across;
+		std::vector<int>					down;
+		bool								overlaps;
+		int									top;
+		int									bottom;
+		int									left;
+		int									right;
+	};
+
+	std::vector<int>						nextLeft_;
+	std::vector<int>						nextTop_;
+	std::vector<DriftBand>					bands_;
+
+	// Not ours; NULL runs everything on the calling thread
+	ThreadPool*								pool_;
+
+	// The kinetic drift keeps a triangulation of the room centers that follows the rooms around
+	// Overlapping rooms can have the same center, so every Vert has a chain of rooms, from driftHeads_ through driftNext_
+	std::vector<VertRef>					driftVerts_;
+	std::vector<std::uint32_t>				driftHeads_;
+	std::vector<std::uint32_t>				driftNext_;
+	PointsList								driftNear_;
+	std::shared_ptr<IntDelaunay>			driftGraph_;
+
+	// The biggest room, which bounds how far apart two overlapping centers can be
+	int										maxWidth_;
+	int										maxHeight_;
+
 	// Resets the center coordinates
 	void Center();
 
 	// We also need to drift the rooms
-	std::map<Rect, Vert> ZeroVelocity();
+	// Each step returns false if nothing overlapped, and then nothing moved
 	void UpdateBounds(const Rect& r);
-	void DriftIterate(std::map<Rect, Vert>& velocity);
-	Vert DriftVector(Rect escapee, Rect collider);
+	Vert DriftVector(Rect escapee, Rect collider, int overlapWidth, int overlapHeight);
+	void Push(std::uint32_t room, std::uint32_t other, int across, int down);
+	void Move();
+	void StartDrift();
+	bool DriftIterate();
+	void DriftBands(std::uint32_t first, std::uint32_t last);
+	void DriftRange(DriftBand& band);
+	void Publish();
 	void Drift();
 	void CreateCorridors();
+	void IndexRooms();
+
+	// Kinetic drift
+	static IntVert CenterOf(const Rect& r);
+	void StartKinetic();
+	bool KineticIterate();
+	bool Collide(std::uint32_t room, std::uint32_t chain);
+	void Chain(std::uint32_t room, VertRef v);
+	void Unchain(std::uint32_t room);
 
 public:
 	static sf::RectangleShape FromRect(const Rect& r);
@@ -80,21 +206,42 @@ public:
 
 	// Constructor
 	Dungeon();
-	Dungeon(int roomsNum);
+	// With a pool, the drift and the triangulations behind the corridors and the room index all use it; it only has to last through the constructor
+	Dungeon(int roomsNum, CorridorMode mode = TREE_CORRIDORS, float loops = 0.0f, DriftMode drift = GRID_DRIFT, SpawnMode spawn = CIRCLE_SPAWN, ThreadPool* pool = NULL);
 
 	// Accessors
 	std::unordered_set<Rect> GetRooms()		{ return rooms_; };
 	std::vector<Corridor> GetCorridors()	{ return corridors_; };
 
+	// The same rooms without the copy, and how many times they've changed
+	const std::unordered_set<Rect>& rooms() const	{ return rooms_; };
+	std::uint32_t version() const			{ return version_; };
+
+	// Only matters for rooms that haven't started drifting yet, so for ScatterRooms and DriftStep
+	void setDriftMode(DriftMode drift)		{ driftMode_ = drift; };
+
+	// Only matters for the next ScatterRooms
+	void setSpawnMode(SpawnMode spawn)		{ spawnMode_ = spawn; };
+
+	// Lets the grid drift split each step across the pool; the rooms end up in the same place whatever the thread count
+	// The kinetic drift stays on the calling thread, since the triangulation it asks isn't safe to ask from more than one
+	void setThreadPool(ThreadPool* pool)	{ pool_ = pool; };
+
 	int top()								{ return top_; };
 	int bottom()							{ return bottom_; };
 	int left()								{ return left_; };
 	int right()								{ return right_; };
 
-	bool CollisionsExist();
+	// The room whose center is closest to (x, y), without looking at every room; false if there are no rooms
+	bool NearestRoom(int x, int y, Rect& room);
 
 	// Generation functions
 	void GenerateRooms(int n);
+
+	// For watching the drift happen: throw rooms down without pushing them apart, then push once per frame
+	// DriftStep returns false once nothing overlaps anymore
+	void ScatterRooms(int n);
+	bool DriftStep();
 };
 
 //	--------------------------------------------------------
@@ -107,14 +254,33 @@ Dungeon::Dungeon()
 	rooms_ = std::unordered_set<Rect>();
 	corridors_ = std::vector<Corridor>();
 	rng_ = DungeonRNG();
+	corridorMode_ = TREE_CORRIDORS;
+	loops_ = 0.0f;
+	driftMode_ = GRID_DRIFT;
+	spawnMode_ = CIRCLE_SPAWN;
+	drifting_ = false;
+	pool_ = NULL;
+	version_ = 0;
+
+	top_ = 0;
+	bottom_ = 0;
+	left_ = 0;
+	right_ = 0;
 }
 
 // Generate n rooms
-Dungeon::Dungeon(int roomsNum)
+Dungeon::Dungeon(int roomsNum, CorridorMode mode, float loops, DriftMode drift, SpawnMode spawn, ThreadPool* pool)
 {
 	rooms_ = std::unordered_set<Rect>();
 	corridors_ = std::vector<Corridor>();
 	rng_ = DungeonRNG();
+	corridorMode_ = mode;
+	loops_ = loops;
+	driftMode_ = drift;
+	spawnMode_ = spawn;
+	drifting_ = false;
+	pool_ = pool;
+	version_ = 0;
 
 	top_ = 0;
 	bottom_ = 0;
@@ -124,16 +290,38 @@ Dungeon::Dungeon(int roomsNum)
 	GenerateRooms(roomsNum);
 	Drift();
 	CreateCorridors();
+	IndexRooms();
+
+	// The caller's pool might not outlive us, and nothing after this needs it
+	pool_ = NULL;
 }
 
 void Dungeon::GenerateRooms(int n)
 {	
-	for (int i = 0; i < n; i++)
+	ScatterRooms(n);
+	Drift();
+}
+
+void Dungeon::ScatterRooms(int n)
+{
+	if (spawnMode_ == POISSON_SPAWN)
 	{
-		rooms_.insert(rng_.GetRoom());
+		std::vector<Rect> spawned;
+		PoissonSpawner(rng_).Spawn(n, spawned);
+		rooms_.insert(spawned.begin(), spawned.end());
+	}
+	else
+	{
+		for (int i = 0; i < n; i++)
+		{
+			rooms_.insert(rng_.GetRoom());
+		}
 	}
 
-	Drift();
+	// Whatever drift was going on was of the old rooms
+	drifting_ = false;
+	driftGraph_.reset();
+	version_++;
 }
 
 //	--------------------------------------------------------
@@ -167,26 +355,9 @@ sf::RectangleShape Dungeon::FromRect(const Rect& r)
 //	Functions for making rooms drift
 //	--------------------------------------------------------
 
-// Checks each room against each other for collision
-// I'm pretty sure we can't do better than O(N^2) on this guy
-bool Dungeon::CollisionsExist()
-{
-	for (auto i = rooms_.begin(); i != rooms_.end(); i++)
-	{
-		for (auto j = rooms_.begin(); j != rooms_.end(); j++)
-		{
-			if (i != j && i->intersects(*j))
-			{
-				return true;
-			}
-		}
-	}
-
-	return false;
-}
-
 // Get the direction that a room will move away from its intersector
-Vert Dungeon::DriftVector(Rect escapee, Rect collider)
+// Whoever found the overlap already knows how big it is, so they pass it in
+Vert Dungeon::DriftVector(Rect escapee, Rect collider, int overlapWidth, int overlapHeight)
 {
 	// Find the nearest edge
 
@@ -201,13 +372,9 @@ Vert Dungeon::DriftVector(Rect escapee, Rect collider)
 	Vert ce = Rect::centroid(escapee);
 	Vert cc = Rect::centroid(collider);
 	
-	// Get the collision area
-	Rect in; 
-	escapee.intersects(collider, in);
-
 	// Round, if necessary
-	float hor = (float)(in.width);
-	float ver = (float)(in.height);
+	float hor = (float)(overlapWidth);
+	float ver = (float)(overlapHeight);
 
 	// Decide the direction to move
 	Direction dir = STAY;
@@ -272,136 +439,457 @@ void Dungeon::UpdateBounds(const Rect& r)
 	right_ = (right_ < r.left + r.width) ? r.left + r.width : right_;
 }
 
-void Dungeon::DriftIterate(std::map<Rect, Vert>& velocity)
+// Each overlapping pair gets one push, worked out from the lower-numbered room's side, and the two rooms take it in opposite directions
+// Every room adds up its own share, so the totals only depend on where everyone was when the step started, not who went first
+void Dungeon::Push(std::uint32_t room, std::uint32_t other, int across, int down)
+{
+	if (room < other)
+	{
+		Vert d = DriftVector(drift_.at(room), drift_.at(other), across, down);
+		pushX_[room] += (int)d.x();
+		pushY_[room] += (int)d.y();
+	}
+	else
+	{
+		Vert d = DriftVector(drift_.at(other), drift_.at(room), across, down);
+		pushX_[room] -= (int)d.x();
+		pushY_[room] -= (int)d.y();
+	}
+}
+
+void Dungeon::Move()
+{
+	// Everybody steps one tile along the sign of their push
+	for (std::uint32_t i = 0; i < drift_.size(); i++)
+	{
+		UpdateBounds(drift_.at(i));
+
+		velocityX_[i] = sgn(pushX_[i]);
+		velocityY_[i] = sgn(pushY_[i]);
+		drift_.left[i] += velocityX_[i];
+		drift_.top[i] += velocityY_[i];
+	}
+
+	version_++;
+}
+
+void Dungeon::StartDrift()
+{
+	// Numbers go out in whatever order the set has the rooms in
+	drift_.Clear();
+	maxWidth_ = 0;
+	maxHeight_ = 0;
+
+	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	{
+		drift_.Add(*r);
+		maxWidth_ = std::max(maxWidth_, r->width);
+		maxHeight_ = std::max(maxHeight_, r->height);
+	}
+
+	std::size_t n = drift_.size();
+	pushX_.assign(n, 0);
+	pushY_.assign(n, 0);
+	velocityX_.assign(n, 0);
+	velocityY_.assign(n, 0);
+	nextLeft_.assign(n, 0);
+	nextTop_.assign(n, 0);
+
+	if (driftMode_ == KINETIC_DRIFT)
+	{
+		StartKinetic();
+	}
+
+	drifting_ = true;
+}
+
+bool Dungeon::DriftIterate()
 // Flock the rectangles apart until none of them touch
 {
 	// Because a bunch of rectangles will push a bunch of other rectangles, get the total pushing and sum it when we move them
-	std::map<Rect, std::vector<Vert>> vectors;
+	// Only rooms that share a cell can collide
+	grid_.Build(drift_);
 
-	// For each rectangle
-	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	// A few bands per thread so a band full of crowded rooms doesn't hold everyone up; too few rooms isn't worth waking anyone for
+	std::uint32_t n = drift_.size();
+	std::uint32_t count = 1;
+
+	if (pool_ != NULL && n >= PARALLEL_CUTOFF)
+	{
+		count = std::max(1u, pool_->threadCount()) * 4;
+	}
+
+	if (bands_.size() < count)
 	{
-		vectors[*r] = std::vector<Vert>();
+		bands_.resize(count);
+	}
+
+	for (std::uint32_t b = 0; b < count; b++)
+	{
+		bands_[b].first = (std::uint64_t)n * b / count;
+		bands_[b].last = (std::uint64_t)n * (b + 1) / count;
+	}
 
-		// For each other rectangle, if the two collide...
-		for (auto s = rooms_.begin(); s != rooms_.end(); s++)
+	DriftBands(0, count);
+
+	bool overlaps = false;
+
+	for (std::uint32_t b = 0; b < count; b++)
+	{
+		overlaps = overlaps || bands_[b].overlaps;
+	}
+
+	if (!overlaps)
+	{
+		return false;
+	}
+
+	for (std::uint32_t b = 0; b < count; b++)
+	{
+		if (bands_[b].first < bands_[b].last)
 		{
-			if (r->intersects(*s) && r != s)
-			{
-				// Get the distance it must travel toward the closest edge of the collider
-				Vert d = DriftVector(*r, *s);
-				vectors[*r].push_back(d);
-				vectors[*s].push_back(Vert(d.x() * -1, d.y() * -1));
-			}
+			UpdateBounds(Rect(bands_[b].left, bands_[b].top, bands_[b].right - bands_[b].left, bands_[b].bottom - bands_[b].top));
 		}
 	}
 
-	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	std::swap(drift_.left, nextLeft_);
+	std::swap(drift_.top, nextTop_);
+	version_++;
+	return true;
+}
+
+void Dungeon::DriftBands(std::uint32_t first, std::uint32_t last)
+{
+	if (last - first == 1)
 	{
-		// Average all the velocities
-		if (vectors[*r].size() > 0)
+		DriftRange(bands_[first]);
+		return;
+	}
+
+	// Fork off the first half, same as the triangulation does
+	std::uint32_t mid = (first + last) / 2;
+
+	PoolTask task([this, first, mid]() { DriftBands(first, mid); });
+	pool_->Submit(&task);
+	DriftBands(mid, last);
+	pool_->Wait(&task);
+}
+
+void Dungeon::DriftRange(DriftBand& band)
+{
+	// Only ever writes to this band's rooms and this band's scratch, and only reads drift_, which nobody touches until the step is over
+	band.overlaps = false;
+
+	if (band.first < band.last)
+	{
+		band.top = drift_.top[band.first];
+		band.bottom = drift_.top[band.first] + drift_.height[band.first];
+		band.left = drift_.left[band.first];
+		band.right = drift_.left[band.first] + drift_.width[band.first];
+	}
+
+	for (std::uint32_t i = band.first; i < band.last; i++)
+	{
+		pushX_[i] = 0;
+		pushY_[i] = 0;
+
+		grid_.Overlapping(drift_, i, band.hits, band.across, band.down);
+
+		for (std::size_t k = 0; k < band.hits.size(); k++)
 		{
-			float x = 0;
-			float y = 0;
+			Push(i, band.hits[k], band.across[k], band.down[k]);
+		}
 
-			auto myVector = vectors[*r];
+		band.overlaps = band.overlaps || !band.hits.empty();
 
-			for (auto f = myVector.begin(); f != myVector.end(); f++)
-			{
-				x += f->x();
-				y += f->y();
-			}
+		// Everybody steps one tile along the sign of their push
+		velocityX_[i] = sgn(pushX_[i]);
+		velocityY_[i] = sgn(pushY_[i]);
+		nextLeft_[i] = drift_.left[i] + velocityX_[i];
+		nextTop_[i] = drift_.top[i] + velocityY_[i];
 
-			x = sgn(x);
-			y = sgn(y);
+		band.top = std::min(band.top, drift_.top[i]);
+		band.bottom = std::max(band.bottom, drift_.top[i] + drift_.height[i]);
+		band.left = std::min(band.left, drift_.left[i]);
+		band.right = std::max(band.right, drift_.left[i] + drift_.width[i]);
+	}
+}
 
-			velocity[*r] = Vert(x, y);
+void Dungeon::Publish()
+{
+	// Back into the set, for everyone outside the drift
+	// The bounds only pick rooms up as they move off, so take in where everyone is now too; rooms that started apart never moved at all
+	rooms_.clear();
+
+	for (std::uint32_t i = 0; i < drift_.size(); i++)
+	{
+		rooms_.insert(drift_.at(i));
+		UpdateBounds(drift_.at(i));
+	}
+}
+
+void Dungeon::Drift()
+{
+	StartDrift();
+
+	// While there are collisions, try to resolve them
+	if (driftMode_ == KINETIC_DRIFT)
+	{
+		while (KineticIterate())
+		{
 		}
-		else
+	}
+	else
+	{
+		while (DriftIterate())
 		{
-			velocity[*r] = Vert(0, 0);
 		}
 	}
 
-	// To modify the set of rectangles, we have to move them into a new one
-	// Ugh
-	std::unordered_set<Rect> rooms;
+	// Nothing overlaps anymore, so no two rooms are the same and the set doesn't lose any
+	Publish();
+	Center();
+	drifting_ = false;
+}
 
-	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+//	--------------------------------------------------------
+//	Kinetic drift
+//	--------------------------------------------------------
+
+IntVert Dungeon::CenterOf(const Rect& r)
+{
+	return IntVert(r.left + r.width / 2, r.top + r.height / 2);
+}
+
+void Dungeon::StartKinetic()
+{
+	std::uint32_t n = drift_.size();
+
+	std::vector<IntVert> centers;
+	centers.reserve(n);
+
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		centers.push_back(CenterOf(drift_.at(i)));
+	}
+
+	driftGraph_ = std::make_shared<IntDelaunay>(centers);
+	driftGraph_->GetTriangulation();
+
+	// Each Vert knows the first room it came from; rooms that landed on the same center find theirs by inserting again
+	driftVerts_.assign(n, NIL);
+
+	for (VertRef v = 0; v < driftGraph_->mesh().vertCount(); v++)
+	{
+		if (!driftGraph_->removed(v))
+		{
+			driftVerts_[driftGraph_->source(v)] = v;
+		}
+	}
+
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		if (driftVerts_[i] == NIL)
+		{
+			driftVerts_[i] = driftGraph_->InsertPoint(centers[i].x(), centers[i].y());
+		}
+	}
+
+	driftHeads_.assign(driftGraph_->mesh().vertCount(), NIL);
+	driftNext_.assign(n, NIL);
+
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		Chain(i, driftVerts_[i]);
+	}
+}
+
+void Dungeon::Chain(std::uint32_t room, VertRef v)
+{
+	if (v >= driftHeads_.size())
 	{
-		// Move the room
-		rooms.insert(Rect(r->left + velocity[*r].x(), r->top + velocity[*r].y(), r->width, r->height));
-		UpdateBounds(*r);
-		// Wipe the velocity
-		velocity[*r] = Vert(0, 0);
+		driftHeads_.resize(v + 1, NIL);
 	}
 
-	// Memory leak?
-	rooms_ = rooms;
+	driftVerts_[room] = v;
+	driftNext_[room] = driftHeads_[v];
+	driftHeads_[v] = room;
 }
 
-std::map<Rect, Vert> Dungeon::ZeroVelocity()
+void Dungeon::Unchain(std::uint32_t room)
 {
-	// Initialize the velocity table
-	std::map<Rect, Vert> velocity;
+	// Chains are only long while rooms are still piled on top of each other
+	std::uint32_t* link = &driftHeads_[driftVerts_[room]];
 
-	// Start it at zero
-	for (auto r = rooms_.begin(); r != rooms_.end(); ++r)
+	while (*link != room)
 	{
-		velocity[*r] = Vert(0, 0);
+		link = &driftNext_[*link];
 	}
 
-	int sizeBefore = rooms_.size();
+	*link = driftNext_[room];
+	driftNext_[room] = NIL;
+}
+
+bool Dungeon::Collide(std::uint32_t room, std::uint32_t chain)
+{
+	bool hit = false;
+
+	int across;
+	int down;
 
-	return velocity;
+	for (std::uint32_t j = chain; j != NIL; j = driftNext_[j])
+	{
+		if (j != room && drift_.Overlaps(room, j, across, down))
+		{
+			Push(room, j, across, down);
+			hit = true;
+		}
+	}
+
+	return hit;
 }
 
-void Dungeon::Drift()
+bool Dungeon::KineticIterate()
 {
-	std::map<Rect, Vert> velocity = ZeroVelocity();
+	std::uint32_t n = drift_.size();
+
+	// Two rooms that overlap have centers less than half their widths apart across, and half their heights apart down
+	bool overlaps = false;
+
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		pushX_[i] = 0;
+		pushY_[i] = 0;
+
+		float across = (drift_.width[i] + maxWidth_) / 2.0f;
+		float down = (drift_.height[i] + maxHeight_) / 2.0f;
+		int radius = (int)ceil(sqrt(across * across + down * down));
+
+		overlaps = Collide(i, driftHeads_[driftVerts_[i]]) || overlaps;
+		driftGraph_->GetNeighborhood(driftVerts_[i], radius, driftNear_);
+
+		for (std::size_t k = 0; k < driftNear_.size(); k++)
+		{
+			overlaps = Collide(i, driftHeads_[driftNear_[k]]) || overlaps;
+		}
+	}
 
-	// While there are collisions
-	while (CollisionsExist())
+	if (!overlaps)
 	{
-		Center();
+		return false;
+	}
+
+	Move();
+
+	// Every room's center moves by exactly its step, so its Vert usually takes a short hop and a couple of flips
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		if (velocityX_[i] == 0 && velocityY_[i] == 0)
+		{
+			continue;
+		}
 
-		// Try to resolve collisions
-		DriftIterate(velocity);
+		IntVert c = CenterOf(drift_.at(i));
+		VertRef v = driftVerts_[i];
+		Unchain(i);
+
+		// A Vert that's still got rooms on it has to stay put, so the room gets a Vert of its own
+		VertRef w = (driftHeads_[v] == NIL) ? driftGraph_->MovePoint(v, c.x(), c.y()) : driftGraph_->InsertPoint(c.x(), c.y());
+		Chain(i, w);
 	}
+
+	return true;
 }
 
 void Dungeon::CreateCorridors()
 {
 	int CORRIDOR_WIDTH = 3;
 
-	std::vector<std::vector<float>> buffer;
+	std::shared_ptr<IntDelaunay> graph = driftGraph_;
 
-	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	if (graph)
 	{
-		if (DungeonRNG::IsLarge((*r)))
+		// The kinetic drift left us a triangulation of every room; nothing overlaps now, so every room has its own Vert
+		// Taking the small rooms out leaves the same triangulation we'd have built from scratch
+		for (std::uint32_t i = 0; i < drift_.size(); i++)
 		{
-			buffer.push_back({ Rect::centroid(*r).x(), Rect::centroid(*r).y() });
+			if (!DungeonRNG::IsLarge(drift_.at(i)))
+			{
+				graph->RemovePoint(driftVerts_[i]);
+			}
 		}
+
+		driftGraph_.reset();
 	}
+	else
+	{
+		// Centroids are whole tiles, so we triangulate them as integers and get exact predicates for free
+		// One flat array; the triangulator sorts and dedupes it itself
+		std::vector<IntVert> centroids;
+		centroids.reserve(rooms_.size());
 
-	std::sort(buffer.begin(), buffer.end());
-	buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+		for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+		{
+			if (DungeonRNG::IsLarge((*r)))
+			{
+				centroids.push_back(CenterOf(*r));
+			}
+		}
+
+		graph = std::make_shared<IntDelaunay>(centroids);
+		graph->setThreadPool(pool_);
+	}
 
 	// We'll get the MST but want to add some corridors back
-	Delaunay del(buffer);
+	IntDelaunay& del = *graph;
 	auto tri = del.GetTriangulation();
 	auto mst = del.GetMST();
 
+	if (corridorMode_ != TREE_CORRIDORS && loops_ > 0.0f)
+	{
+		// Roll for each edge that isn't already in the tree; the proximity graphs contain the tree, so there are no repeats
+		auto extra = (corridorMode_ == GABRIEL_CORRIDORS) ? del.GetGabriel() : del.GetRelativeNeighbors();
+		std::unordered_set<EdgeRef> inTree;
+
+		for (auto c = mst.begin(); c != mst.end(); c++)
+		{
+			inTree.insert((*c) & ~3u);
+		}
+
+		for (auto c = extra.begin(); c != extra.end(); c++)
+		{
+			if (inTree.count(*c) == 0 && rng_.Chance() < loops_)
+			{
+				mst.push_back(*c);
+			}
+		}
+	}
+
 	// For each corridor, go horizontal then vertical
-	// Also remember the rooms we intersect
-	std::unordered_set<Rect> hitRooms;
+	// Also remember the rooms we intersect; every corridor gets tested against all the rooms, a block at a time
+	RectArrays rooms;
+	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	{
+		rooms.Add(*r);
+	}
+
+	// Large rooms always stay, as long as there are any corridors at all
+	std::vector<bool> hit(rooms.size(), false);
+
+	for (std::uint32_t i = 0; i < rooms.size() && !mst.empty(); i++)
+	{
+		hit[i] = DungeonRNG::IsLarge(rooms.at(i));
+	}
 	
 	for (auto c = mst.begin(); c != mst.end(); c++)
 	{
+		const IntVert& org = del.mesh().origin(*c);
+		const IntVert& dest = del.mesh().destination(*c);
+
 		// Construct the horizontal corridor
-		int x1 = floor((*c)->origin()->x());
-		int x2 = floor((*c)->destination()->x());
-		int y = floor((*c)->origin()->y());
+		int x1 = org.x();
+		int x2 = dest.x();
+		int y = org.y();
 
 		int left = x1;
 		int right = x2;
@@ -415,7 +903,7 @@ void Dungeon::CreateCorridors()
 		corridors_.push_back(Corridor(left, y - 1, (right - left + 1), 3, true));
 
 		// Construct the vertical corridor
-		int y2 = floor((*c)->destination()->y());
+		int y2 = dest.y();
 
 		int top = y;
 		int bottom = y2;
@@ -428,60 +916,98 @@ void Dungeon::CreateCorridors()
 
 		corridors_.push_back(Corridor(x2 - 1, top, 3, (bottom - top + 1), false));
 
-		for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+		// If the horizontal or vertical line segment intersects, then save the room
+		// A room counts if it's strictly between the ends of the segment and overlaps the three tiles across it
+		Rect across(left, y - 1, right - left, 3);
+		Rect down(x2 - 1, top, 3, bottom - top);
+
+		for (std::size_t k = 0; k < rooms.size(); k += OVERLAP_BLOCK)
 		{
-			// If it's a large room, save it
-			if (DungeonRNG::IsLarge(*r))
-			{
-				hitRooms.insert(*r);
-			}
+			std::size_t count = std::min(OVERLAP_BLOCK, rooms.size() - k);
+			std::uint32_t mask = CrossingMask(across, true, rooms, k, count) | CrossingMask(down, false, rooms, k, count);
 
-			// If the horizontal line segment intersects, then save the room
-			if (r->top < y + 2 && r->top + r->height > y - 1 && r->left > left && r->left + r->width < right)
+			for (; mask != 0; mask &= mask - 1)
 			{
-				hitRooms.insert(*r);
+				hit[k + LowestBit(mask)] = true;
 			}
+		}
+	}
 
-			// If the vertical line segment intersects, then save the room
-			if (r->left < x2 + 2 && r->left + r->width > x2 - 1 && r->top > top && r->top + r->height < bottom)
-			{
-				hitRooms.insert(*r);
-			}
+	std::unordered_set<Rect> hitRooms;
+	for (std::uint32_t i = 0; i < rooms.size(); i++)
+	{
+		if (hit[i])
+		{
+			hitRooms.insert(rooms.at(i));
 		}
 	}
 
 	rooms_ = hitRooms;
+	version_++;
+}
+
+//	--------------------------------------------------------
+//	Finding rooms
+//	--------------------------------------------------------
+
+void Dungeon::IndexRooms()
+{
+	roomList_.assign(rooms_.begin(), rooms_.end());
+
+	std::vector<IntVert> centers;
+	centers.reserve(roomList_.size());
+
+	for (auto r = roomList_.begin(); r != roomList_.end(); r++)
+	{
+		centers.push_back(IntVert(r->left + r->width / 2, r->top + r->height / 2));
+	}
+
+	// The locator builds the triangulation, so the pool only has to be there for that; the graph outlives it
+	roomGraph_ = std::make_shared<IntDelaunay>(centers);
+	roomGraph_->setThreadPool(pool_);
+	roomLocator_ = std::make_shared<IntLocator>(*roomGraph_);
+	roomGraph_->setThreadPool(NULL);
+}
+
+bool Dungeon::NearestRoom(int x, int y, Rect& room)
+{
+	if (!roomLocator_)
+	{
+		return false;
+	}
+
+	VertRef v = roomLocator_->Nearest(x, y);
+	if (v == NIL)
+	{
+		return false;
+	}
+
+	room = roomList_[roomGraph_->source(v)];
+	return true;
 }
 
 //	--------------------------------------------------------
 //	For drawing the wandering
 //	--------------------------------------------------------
 
-/*
-void Dungeon::DriftAndRender(std::map<Rect, Vert>& velocity, sf::RenderWindow& window)
+// One iteration of Drift; the overlay picks up the new positions from the version bump
+bool Dungeon::DriftStep()
 {
-	Center();
+	if (!drifting_)
+	{
+		StartDrift();
+	}
 
-	// Try to resolve collisions
-	DriftIterate(velocity);
+	bool moved = (driftMode_ == KINETIC_DRIFT) ? KineticIterate() : DriftIterate();
+	Publish();
 
-	// Create a renderable shape from each room and render it
-	for (auto r = rooms_.begin(); r != rooms_.end(); r++)
+	if (!moved)
 	{
-		sf::RectangleShape renderRect = FromRect((*r));
-		if (DungeonRNG::IsLarge((*r)))
-		{
-			renderRect.setFillColor(sf::Color::White);
-		}
-		else
-		{
-			renderRect.setFillColor(sf::Color::Blue);
-		}
-		
-		window.draw(renderRect);
+		drifting_ = false;
 	}
+
+	return moved;
 }
-*/
 
 //	--------------------------------------------------------
 
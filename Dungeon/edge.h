@@ -1,7 +1,7 @@
 //	--------------------------------------------------------
 //	EDGE.H
 //	--------------------------------------------------------
-//	Contains edges that rotate themmselves using fancy memory tricks
+//	Contains edges that rotate themselves using fancy index tricks
 //	Introduced by Guibas and Stolfi (1985)
 //	(Adapted from code presented on Paul Heckbert's webpage)
 //	http://www.cs.cmu.edu/afs/andrew/scs/cs/15-463/2001/pub/src/a2/quadedge.html
@@ -14,188 +14,73 @@
 //	Include
 //	--------------------------------------------------------
 
-#include <SFML/Graphics.hpp>
-#include <memory>
-
-//	--------------------------------------------------------
-//	Forward declarations because C++
-//	--------------------------------------------------------
-
-class Edge;
-class QuadEdge;
+#include <cstdint>
 
 //	--------------------------------------------------------
 //	The Vert class
 //	--------------------------------------------------------
 
-// This extends the SFML class, which, yes, costs some memory for computation
-// This is a nominal thing so I don't get a headache; I could rewrite the code to use just int tuples
-// (And probably should)
-class Vert : public sf::Vertex
+// Just a pair of coordinates; this used to extend sf::Vertex, which cost us a color and texture coordinates per point
+// The mesh keeps track of which edge leaves each Vert, so this doesn't have to
+// It's a template so the dungeon can triangulate integer tile coordinates exactly
+template <typename T>
+class BasicVert
 {
 private:
-	Edge*												edge_;
+	T													x_;
+	T													y_;
 public:
-	Vert();
-	Vert(float x, float y);
+	typedef T											Coord;
 
-	Edge*												edge()									{ return edge_; };
-	void												AddEdge(Edge* edge)						{ edge_ = edge; };
+	BasicVert();
+	BasicVert(T x, T y);
 
-	float												x()										{ return position.x; };
-	float												y()										{ return position.y; };
-	float												lengthsquared()							{ return position.x * position.x + position.y * position.y; };
-
-	sf::Vector2f										getPosition()							{ return position; };
+	T													x() const								{ return x_; };
+	T													y() const								{ return y_; };
+	T													lengthsquared() const					{ return x_ * x_ + y_ * y_; };
 };
 
-//	--------------------------------------------------------
-//	Constructor
-//	--------------------------------------------------------
-
-Vert::Vert()
-{
-}
-
-Vert::Vert(float x, float y)
-{
-	position = sf::Vector2f(x, y);
-}
-
-//	--------------------------------------------------------
-//	The Edge class
-//	--------------------------------------------------------
-
-// Notably this guy points to only one Vert and knows its own index and next edge about its origin Vert
-class Edge
-{
-private:
-	Vert*												origin_;
-	int													index_;
-	Edge*												next_;
-
-	friend QuadEdge;
-
-public:
-	Edge(Vert* _origin);
-	Edge();
-	~Edge();
-
-	bool												draw;
-
-	int index()											{ return index_; };
-
-	// An Edge object has four primitive algebraic operations; see Guibas and Stolfi
-
-	Edge* Rot();
-	Edge* InvRot();
-	Edge* Sym();
-	Edge* Onext()										{ return next_; };
-
-	// These guys can be derived from the four primitive operations
-
-	Edge* Oprev()										{ return Rot()->Onext()->Rot(); };
-	Edge* Dnext()										{ return Sym()->Onext()->Sym(); };
-	Edge* Dprev()										{ return InvRot()->Onext()->InvRot(); };
-	Edge* Lnext()										{ return InvRot()->Onext()->Rot(); };
-	Edge* Lprev()										{ return Onext()->Sym(); };
-	Edge* Rnext()										{ return Rot()->Onext()->InvRot(); };
-	Edge* Rprev()										{ return Sym()->Onext(); };
-
-	// Accessors and mutators
-
-	Vert* origin()										{ return origin_; };
-	Vert* destination()									{ return Sym()->origin(); };
-		
-	void setNext(Edge* next)							{ next_ = next; };
-	void setIndex(int index)							{ index_ = index; };
-	void setOrigin(Vert* org);
-	void setOrigin(sf::Vector2f org);
-	void setDestination(Vert* dest);
-
-	// Uses raw pointer because it's returning the array member of a QuadEdge
-	static Edge* Make(std::vector<QuadEdge*>& list);
-};
+typedef BasicVert<float>								Vert;
+typedef BasicVert<int>									IntVert;
 
 //	--------------------------------------------------------
-//	Constructors and destructors
+//	Constructor
 //	--------------------------------------------------------
 
-Edge::Edge()
-{
-}
-
-Edge::~Edge()
+template <typename T>
+BasicVert<T>::BasicVert() : x_(0), y_(0)
 {
 }
 
-Edge::Edge(Vert* _origin) : origin_(_origin)
+template <typename T>
+BasicVert<T>::BasicVert(T x, T y) : x_(x), y_(y)
 {
 }
 
 //	--------------------------------------------------------
-//	Member functions too complex to inline
+//	Edge references
 //	--------------------------------------------------------
 
-Edge* Edge::Rot()
-{
-	return (index_ < 3) ? (this + 1) : (this - 3);
-};
+// An edge is a 32-bit index into the mesh's record array
+// The top 30 bits pick the QuadEdge and the bottom 2 bits pick which of its four edges we mean
+// That makes Rot, InvRot and Sym pure bit twiddling; only Onext needs to look at memory
+typedef std::uint32_t									EdgeRef;
+typedef std::uint32_t									VertRef;
 
-Edge* Edge::InvRot()
-{
-	return (index_ > 0) ? (this - 1) : (this + 3);
-}	
+// Marks an empty slot, whether it's an edge or a vertex
+const std::uint32_t										NIL = 0xffffffff;
 
-Edge* Edge::Sym()
-{
-	return (index_ < 2) ? (this + 2) : (this - 2);
-}
+inline EdgeRef Rot(EdgeRef e)							{ return (e & ~3u) | ((e + 1) & 3u); };
+inline EdgeRef InvRot(EdgeRef e)						{ return (e & ~3u) | ((e + 3) & 3u); };
+inline EdgeRef Sym(EdgeRef e)							{ return e ^ 2u; };
 
-void Edge::setOrigin(Vert* origin)
-{
-	origin->AddEdge(this);
-	origin_ = origin;
-	draw = true;
-}
+// The QuadEdge an edge belongs to, and that QuadEdge's 0th edge
+inline std::uint32_t Quad(EdgeRef e)					{ return e >> 2; };
+inline EdgeRef Canonical(EdgeRef e)						{ return e & ~3u; };
 
-void Edge::setOrigin(sf::Vector2f origin)
-{
-	origin_ = new Vert(origin.x, origin.y);
-	origin_->AddEdge(this);
-	draw = true;
-}
-
-void Edge::setDestination(Vert* dest)
-{
-	Edge* sym = Sym();
-	dest->AddEdge(sym);
-	sym->setOrigin(dest);
-}
-
-//	--------------------------------------------------------
-//	Uh, this guy
-//	--------------------------------------------------------
-
-void Splice(Edge* a, Edge* b)
-{
-	// This remains unintelligible to me
-	// See Guibas and Stolfi, also Heckbert's code
-
-	Edge* alpha = a->Onext()->Rot();
-	Edge* beta = b->Onext()->Rot();
-
-	Edge* t1 = b->Onext();
-	Edge* t2 = a->Onext();
-	Edge* t3 = beta->Onext();
-	Edge* t4 = alpha->Onext();
-
-	a->setNext(t1);
-	b->setNext(t2);
-	alpha->setNext(t3);
-	beta->setNext(t4);
-}
+// Primal edges connect Verts; the odd rotations connect faces
+inline bool IsPrimal(EdgeRef e)							{ return (e & 1u) == 0; };
 
 //	--------------------------------------------------------
 
-#endif
\ No newline at end of file
+#endif
@@ -13,6 +13,7 @@
 
 #include "dungeon.h"
 #include "map.h"
+#include "overlay.h"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window/Keyboard.hpp>
@@ -180,59 +181,6 @@ void GameWorld::RenderDungeon(sf::RenderWindow& window)
 }
 */
 
-//	--------------------------------------------------------
-//	Miscellaneous debug stuff
-//	--------------------------------------------------------
-
-void DrawEdge(Edge* e, sf::RenderWindow& window, const sf::Color& color)
-{
-	Edge* sym = e->Sym();
-	Vert* destination = e->destination();
-	Vert org = *(e->origin());
-	Vert dest = *(e->destination());
-
-	sf::VertexArray v(sf::Lines, 2);
-
-	v[0].position = sf::Vector2f(org.x(), org.y());
-	v[0].color = color;
-	v[1].position = sf::Vector2f(dest.x(), dest.y());
-	v[1].color = color;
-
-	window.draw(v);
-}
-
-void DrawDungeonEdge(Edge* e, sf::RenderWindow& window, const sf::Color& color)
-{
-	Edge* sym = e->Sym();
-	Vert* destination = e->destination();
-	Vert org = *(e->origin());
-	Vert dest = *(e->destination());
-
-	sf::VertexArray v(sf::Lines, 2);
-
-	v[0].position = sf::Vector2f(org.x() * TILE_SIZE + WINDOW_WIDTH / 2, org.y() * TILE_SIZE + WINDOW_HEIGHT / 2);
-	v[0].color = color;
-	v[1].position = sf::Vector2f(dest.x() * TILE_SIZE + WINDOW_WIDTH / 2, dest.y() * TILE_SIZE + WINDOW_HEIGHT / 2);
-	v[1].color = color;
-
-	window.draw(v);
-}
-
-void DrawVoronoi(Edge* e, sf::RenderWindow& window)
-{
-	sf::VertexArray v(sf::Lines, 2);
-
-	Vert* org = e[1].origin();
-	Vert* dest = e[3].origin();
-
-	v[0].position = sf::Vector2f(org->x(), org->y());
-	v[0].color = sf::Color::Green;
-	v[1].position = sf::Vector2f(dest->x(), dest->y());
-	v[1].color = sf::Color::Green;
-
-	window.draw(v);
-}
-
 //	--------------------------------------------------------
 
 #endif
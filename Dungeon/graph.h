@@ -0,0 +1,219 @@
+//	--------------------------------------------------------
+//	GRAPH.H
+//	--------------------------------------------------------
+//	Contains flat helpers for graph algorithms on the triangulation: a union-find and an indexed heap
+//	Both are keyed by Vert index and keep their arrays between uses
+//	--------------------------------------------------------
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include <cstdint>
+#include <vector>
+
+//	--------------------------------------------------------
+//	Union-find
+//	--------------------------------------------------------
+
+// Union by rank with path halving, so everything is as good as constant time
+class DisjointSets
+{
+private:
+	std::vector<std::uint32_t>							parent_;
+	std::vector<std::uint8_t>							rank_;
+
+public:
+	// Everybody starts out alone
+	void												Reset(std::uint32_t n);
+
+	std::uint32_t										Find(std::uint32_t a);
+
+	// Returns false if they were already together
+	bool												Union(std::uint32_t a, std::uint32_t b);
+};
+
+inline void DisjointSets::Reset(std::uint32_t n)
+{
+	parent_.resize(n);
+	rank_.assign(n, 0);
+
+	for (std::uint32_t i = 0; i < n; i++)
+	{
+		parent_[i] = i;
+	}
+}
+
+inline std::uint32_t DisjointSets::Find(std::uint32_t a)
+{
+	while (parent_[a] != a)
+	{
+		// Point at our grandparent on the way up, which flattens the tree as we go
+		parent_[a] = parent_[parent_[a]];
+		a = parent_[a];
+	}
+
+	return a;
+}
+
+inline bool DisjointSets::Union(std::uint32_t a, std::uint32_t b)
+{
+	a = Find(a);
+	b = Find(b);
+
+	if (a == b)
+	{
+		return false;
+	}
+
+	// Hang the shorter tree off the taller one
+	if (rank_[a] < rank_[b])
+	{
+		parent_[a] = b;
+	}
+	else if (rank_[a] > rank_[b])
+	{
+		parent_[b] = a;
+	}
+	else
+	{
+		parent_[b] = a;
+		rank_[a]++;
+	}
+
+	return true;
+}
+
+//	--------------------------------------------------------
+//	Indexed heap
+//	--------------------------------------------------------
+
+// Where an id sits when it isn't in the heap
+const std::uint32_t NIL_POSITION = 0xffffffff;
+
+// A binary min-heap of ids in [0, n) with 64-bit keys
+// It remembers where each id sits, so lowering a key doesn't mean searching for it
+class IndexedHeap
+{
+private:
+	std::vector<std::uint32_t>							heap_;
+	std::vector<std::uint32_t>							position_;								// NIL_POSITION if it isn't in the heap
+	std::vector<std::uint64_t>							keys_;
+
+	void												Place(std::uint32_t slot, std::uint32_t id);
+	void												SiftUp(std::uint32_t slot);
+	void												SiftDown(std::uint32_t slot);
+
+public:
+	void												Reset(std::uint32_t n);
+
+	bool												empty() const							{ return heap_.empty(); };
+	bool												Contains(std::uint32_t id) const		{ return position_[id] != NIL_POSITION; };
+	std::uint64_t										key(std::uint32_t id) const				{ return keys_[id]; };
+
+	// Adds the id if it isn't there, or lowers its key if the new one is smaller
+	// Returns true if anything changed
+	bool												Push(std::uint32_t id, std::uint64_t key);
+	std::uint32_t										Pop();
+};
+
+inline void IndexedHeap::Reset(std::uint32_t n)
+{
+	heap_.clear();
+	position_.assign(n, NIL_POSITION);
+	keys_.resize(n);
+}
+
+inline void IndexedHeap::Place(std::uint32_t slot, std::uint32_t id)
+{
+	heap_[slot] = id;
+	position_[id] = slot;
+}
+
+inline void IndexedHeap::SiftUp(std::uint32_t slot)
+{
+	std::uint32_t id = heap_[slot];
+
+	while (slot > 0)
+	{
+		std::uint32_t parent = (slot - 1) / 2;
+		if (keys_[heap_[parent]] <= keys_[id])
+		{
+			break;
+		}
+		Place(slot, heap_[parent]);
+		slot = parent;
+	}
+
+	Place(slot, id);
+}
+
+inline void IndexedHeap::SiftDown(std::uint32_t slot)
+{
+	std::uint32_t id = heap_[slot];
+	std::uint32_t n = heap_.size();
+
+	while (true)
+	{
+		std::uint32_t child = slot * 2 + 1;
+		if (child >= n)
+		{
+			break;
+		}
+		if (child + 1 < n && keys_[heap_[child + 1]] < keys_[heap_[child]])
+		{
+			child++;
+		}
+		if (keys_[id] <= keys_[heap_[child]])
+		{
+			break;
+		}
+		Place(slot, heap_[child]);
+		slot = child;
+	}
+
+	Place(slot, id);
+}
+
+inline bool IndexedHeap::Push(std::uint32_t id, std::uint64_t key)
+{
+	if (position_[id] == NIL_POSITION)
+	{
+		keys_[id] = key;
+		heap_.push_back(id);
+		SiftUp(heap_.size() - 1);
+		return true;
+	}
+
+	if (key < keys_[id])
+	{
+		keys_[id] = key;
+		SiftUp(position_[id]);
+		return true;
+	}
+
+	return false;
+}
+
+inline std::uint32_t IndexedHeap::Pop()
+{
+	std::uint32_t top = heap_[0];
+	std::uint32_t last = heap_.back();
+	heap_.pop_back();
+	position_[top] = NIL_POSITION;
+
+	if (!heap_.empty())
+	{
+		Place(0, last);
+		SiftDown(0);
+	}
+
+	return top;
+}
+
+//	--------------------------------------------------------
+
+#endif
@@ -0,0 +1,255 @@
+//	--------------------------------------------------------
+//	GRID.H
+//	--------------------------------------------------------
+//	Contains a uniform grid over the rooms, for finding the ones that overlap without checking every pair
+//	--------------------------------------------------------
+
+#ifndef GRID_H
+#define GRID_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "overlap.h"
+#include "rect.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+// Cells are square and at least as big as the biggest room, so a room covers at most two cells each way
+// Two rooms can only overlap if they share a cell, and the cell holding the top left corner of their overlap is one they share,
+// so each overlapping pair gets reported from exactly that cell and never twice
+// Rooms go by their numbers in the arrays handed to Build; the grid keeps its own copy of each room next to its number,
+// so the rooms in a cell can be tested a block at a time, and moving a room doesn't move it in the grid until the next Build
+class RoomGrid
+{
+private:
+	// Where the grid starts, in tiles, and how big it is
+	int											left_;
+	int											top_;
+	int											cellSize_;
+	int											columns_;
+	int											rows_;
+
+	// The rooms in each cell, packed: cell c holds cellRooms_[cellStarts_[c], cellStarts_[c + 1])
+	// Counted and then filled, so a rebuild reuses the memory and never sorts
+	std::vector<std::uint32_t>					cellStarts_;
+	std::vector<std::uint32_t>					cellRooms_;
+
+	// A copy of each of those rooms, in the same order, so a cell's rooms sit next to each other and get tested a block at a time
+	RectArrays									cellRects_;
+
+	int											Column(int x) const					{ return (x - left_) / cellSize_; };
+	int											Row(int y) const					{ return (y - top_) / cellSize_; };
+
+public:
+	RoomGrid();
+
+	// Bin every room into the cells it covers
+	// Rooms only move a tile at a time, so rebuilding once a step is cheaper than it sounds; it's linear in the rooms
+	void										Build(const RectArrays& rooms);
+
+	// Every room that overlaps rooms[room], not counting itself, each once
+	void										Overlapping(const RectArrays& rooms, std::uint32_t room, std::vector<std::uint32_t>& out) const;
+
+	// Same, and how far each one overlaps it across and down, in the same order
+	void										Overlapping(const RectArrays& rooms, std::uint32_t room, std::vector<std::uint32_t>& out, std::vector<int>& across, std::vector<int>& down) const;
+};
+
+//	--------------------------------------------------------
+//	Constructor
+//	--------------------------------------------------------
+
+RoomGrid::RoomGrid() : left_(0), top_(0), cellSize_(1), columns_(0), rows_(0)
+{
+
+}
+
+//	--------------------------------------------------------
+//	Building
+//	--------------------------------------------------------
+
+void RoomGrid::Build(const RectArrays& rooms)
+{
+	cellStarts_.clear();
+	cellRooms_.clear();
+	cellRects_.Clear();
+	columns_ = 0;
+	rows_ = 0;
+
+	if (rooms.size() == 0)
+	{
+		return;
+	}
+
+	// Bounds, and the biggest room
+	int left = rooms.left[0];
+	int top = rooms.top[0];
+	int right = rooms.left[0] + rooms.width[0];
+	int bottom = rooms.top[0] + rooms.height[0];
+	int biggest = 1;
+
+	for (std::size_t i = 0; i < rooms.size(); i++)
+	{
+		left = std::min(left, rooms.left[i]);
+		top = std::min(top, rooms.top[i]);
+		right = std::max(right, rooms.left[i] + rooms.width[i]);
+		bottom = std::max(bottom, rooms.top[i] + rooms.height[i]);
+		biggest = std::max(biggest, std::max(rooms.width[i], rooms.height[i]));
+	}
+
+	// Keep it to about two cells per room; rooms strung out in a long line would otherwise make a mostly empty grid
+	// Bigger cells never break anything, they just hold more rooms each
+	left_ = left;
+	top_ = top;
+	cellSize_ = biggest;
+
+	while (true)
+	{
+		columns_ = (right - left) / cellSize_ + 1;
+		rows_ = (bottom - top) / cellSize_ + 1;
+
+		if ((std::uint64_t)columns_ * rows_ <= 2 * rooms.size() + 16)
+		{
+			break;
+		}
+
+		cellSize_ *= 2;
+	}
+
+	// Count, then add the counts up so each cell knows where it ends, then fill each cell from the back,
+	// which walks its end down to its start and leaves the rooms in each cell in order
+	std::size_t cells = (std::size_t)columns_ * rows_;
+	cellStarts_.assign(cells + 1, 0);
+
+	for (std::size_t i = 0; i < rooms.size(); i++)
+	{
+		for (int y = Row(rooms.top[i]); y <= Row(rooms.top[i] + rooms.height[i] - 1); y++)
+		{
+			for (int x = Column(rooms.left[i]); x <= Column(rooms.left[i] + rooms.width[i] - 1); x++)
+			{
+				cellStarts_[y * columns_ + x]++;
+			}
+		}
+	}
+
+	for (std::size_t c = 1; c < cells; c++)
+	{
+		cellStarts_[c] += cellStarts_[c - 1];
+	}
+
+	cellStarts_[cells] = cellStarts_[cells - 1];
+	cellRooms_.resize(cellStarts_[cells]);
+	cellRects_.left.resize(cellStarts_[cells]);
+	cellRects_.top.resize(cellStarts_[cells]);
+	cellRects_.width.resize(cellStarts_[cells]);
+	cellRects_.height.resize(cellStarts_[cells]);
+
+	for (std::size_t i = rooms.size(); i-- > 0;)
+	{
+		for (int y = Row(rooms.top[i]); y <= Row(rooms.top[i] + rooms.height[i] - 1); y++)
+		{
+			for (int x = Column(rooms.left[i]); x <= Column(rooms.left[i] + rooms.width[i] - 1); x++)
+			{
+				std::uint32_t k = --cellStarts_[y * columns_ + x];
+				cellRooms_[k] = i;
+				cellRects_.left[k] = rooms.left[i];
+				cellRects_.top[k] = rooms.top[i];
+				cellRects_.width[k] = rooms.width[i];
+				cellRects_.height[k] = rooms.height[i];
+			}
+		}
+	}
+}
+
+//	--------------------------------------------------------
+//	Queries
+//	--------------------------------------------------------
+
+void RoomGrid::Overlapping(const RectArrays& rooms, std::uint32_t room, std::vector<std::uint32_t>& out) const
+{
+	out.clear();
+
+	if (columns_ == 0)
+	{
+		return;
+	}
+
+	Rect r = rooms.at(room);
+
+	for (int y = Row(r.top); y <= Row(r.top + r.height - 1); y++)
+	{
+		for (int x = Column(r.left); x <= Column(r.left + r.width - 1); x++)
+		{
+			std::size_t c = y * columns_ + x;
+
+			for (std::uint32_t k = cellStarts_[c]; k < cellStarts_[c + 1]; k += OVERLAP_BLOCK)
+			{
+				std::uint32_t mask = OverlapMask(r, cellRects_, k, std::min<std::size_t>(OVERLAP_BLOCK, cellStarts_[c + 1] - k));
+
+				for (; mask != 0; mask &= mask - 1)
+				{
+					std::uint32_t at = k + LowestBit(mask);
+
+					// Only count it from the cell with the top left corner of the overlap in it
+					if (cellRooms_[at] != room && Column(std::max(r.left, cellRects_.left[at])) == x && Row(std::max(r.top, cellRects_.top[at])) == y)
+					{
+						out.push_back(cellRooms_[at]);
+					}
+				}
+			}
+		}
+	}
+}
+
+void RoomGrid::Overlapping(const RectArrays& rooms, std::uint32_t room, std::vector<std::uint32_t>& out, std::vector<int>& across, std::vector<int>& down) const
+{
+	out.clear();
+	across.clear();
+	down.clear();
+
+	if (columns_ == 0)
+	{
+		return;
+	}
+
+	Rect r = rooms.at(room);
+	int blockAcross[OVERLAP_BLOCK];
+	int blockDown[OVERLAP_BLOCK];
+
+	for (int y = Row(r.top); y <= Row(r.top + r.height - 1); y++)
+	{
+		for (int x = Column(r.left); x <= Column(r.left + r.width - 1); x++)
+		{
+			std::size_t c = y * columns_ + x;
+
+			for (std::uint32_t k = cellStarts_[c]; k < cellStarts_[c + 1]; k += OVERLAP_BLOCK)
+			{
+				std::uint32_t mask = OverlapExtents(r, cellRects_, k, std::min<std::size_t>(OVERLAP_BLOCK, cellStarts_[c + 1] - k), blockAcross, blockDown);
+
+				for (; mask != 0; mask &= mask - 1)
+				{
+					int bit = LowestBit(mask);
+					std::uint32_t at = k + bit;
+
+					if (cellRooms_[at] != room && Column(std::max(r.left, cellRects_.left[at])) == x && Row(std::max(r.top, cellRects_.top[at])) == y)
+					{
+						out.push_back(cellRooms_[at]);
+						across.push_back(blockAcross[bit]);
+						down.push_back(blockDown[bit]);
+					}
+				}
+			}
+		}
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
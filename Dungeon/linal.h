@@ -13,6 +13,8 @@
 
 #include "tileset.h"
 #include "edge.h"
+#include "quadedge.h"
+#include "predicates.h"
 
 //	--------------------------------------------------------
 //	Some definitions
@@ -40,7 +42,7 @@ template <typename T> int sgn(T val)
 
 // We assume that tiles are placed about 0, 0
 // This maps tile coords to screen coords
-Vert FromTileCoords(Vert& v)
+Vert FromTileCoords(const Vert& v)
 {
 	return Vert(v.x() * TILE_SIZE + WINDOW_WIDTH / 2, v.y() * TILE_SIZE + WINDOW_HEIGHT / 2);
 }
@@ -56,124 +58,190 @@ sf::Vector2f FromTileCoords(float x, float y)
 }
 
 //	--------------------------------------------------------
-//	Bunch of linear algebra functions
+//	Geometric predicates
 //	--------------------------------------------------------
 
-double Det3x3(double* col_0, double* col_1, double* col_2)
-{
-	// Gets the determinant of a 3x3 matrix, where the arguments are 3-long column vectors
-
-	// Names all the objects in the matrix for my convenience
-	double a = col_0[0];
-	double b = col_1[0];
-	double c = col_2[0];
-	double d = col_0[1];
-	double e = col_1[1];
-	double f = col_2[1];
-	double g = col_0[2];
-	double h = col_1[2];
-	double i = col_2[2];
-
-	// Return the alternating sum of the 2x2 determinants of the coproducts
-	double det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
-	return det;
-}
+// The predicates below are templates on the coordinate type
+// Integer Verts get exact 64/128-bit arithmetic; float Verts get the filtered path; predicates.h picks at compile time
 
-double Det4x4(double* col_0, double* col_1, double* col_2, double* col_3)
-{
-	// Gets the determinant of a 4x4 matrix, where the arguments are 4-long column vectors
-
-	// Name all the objects in the matrix for my convenience
-	double a = col_0[0];
-	double b = col_1[0];
-	double c = col_2[0];
-	double d = col_3[0];
-	double e = col_0[1];
-	double f = col_1[1];
-	double g = col_2[1];
-	double h = col_3[1];
-	double i = col_0[2];
-	double j = col_1[2];
-	double k = col_2[2];
-	double l = col_3[2];
-	double m = col_0[3];
-	double n = col_1[3];
-	double o = col_2[3];
-	double p = col_3[3];
-
-	// Compute 3x3 determinants
-	double adet = a * ((f * k * p) - (f * l * o) - (g * j * p) + (g * l * n) + (h * j * o) - (h * k * n));
-	double bdet = b * ((e * k * p) - (e * l * o) - (g * i * p) + (g * l * m) + (h * i * o) - (h * k * m));
-	double cdet = c * ((e * j * p) - (e * l * n) - (f * i * p) + (f * l * m) + (h * i * n) - (h * j * m));
-	double ddet = d * ((e * j * o) - (e * k * n) - (f * i * o) + (f * k * m) + (g * i * n) - (g * j * m));
-
-	// Return their alternating sum
-	double det = adet - bdet + cdet - ddet;
-	return det;
-}
-
-bool InCircle(Vert* a, Vert* b, Vert* c, Vert* d)
+template <typename T> bool InCircle(const BasicVert<T>& a, const BasicVert<T>& b, const BasicVert<T>& c, const BasicVert<T>& d)
 {
-	// Returns true if d is in the circle circumscribing the triangle [abc]
-	// This reduces to a linear algebraic question; see Guibas and Stolfi
-
-	// Set up our matrix
-	double m[4][4] = {	{ a->x(), b->x(), c->x(), d->x() },
-						{ a->y(), b->y(), c->y(), d->y() },
-						{ a->lengthsquared(), b->lengthsquared(), c->lengthsquared(), d->lengthsquared() },
-						{ 1, 1, 1, 1 } };
-
-	// Return true if our determinant is positive
-	return Det4x4(m[0], m[1], m[2], m[3]) > 0;
+	// Returns true if d is in the circle circumscribing the triangle [abc]; see Guibas and Stolfi
+	// The lifted 4x4 determinant collapses to a 3x3 once we move d to the origin, and predicates.h keeps it exact
+	return InCircleSign(a.x(), a.y(), b.x(), b.y(), c.x(), c.y(), d.x(), d.y()) > 0;
 }
 
-bool CCW(Vert* a, Vert* b, Vert* c)
+template <typename T> bool CCW(const BasicVert<T>& a, const BasicVert<T>& b, const BasicVert<T>& c)
 {
 	// Returns true if c lies above the line through a and b
 	// Bear in mind that this is mirrored when rendering because of SFML conventions
-	// This reduces to a linear algebraic question; see Guibas and Stolfi
-
-	// This following bit might not be necessary
-	float a_x = a->x();
-	float a_y = a->y();
-	float b_x = b->x();
-	float b_y = b->y();
-	float c_x = c->x();
-	float c_y = c->y();
+	return OrientSign(a.x(), a.y(), b.x(), b.y(), c.x(), c.y()) > 0;
+}
 
-	// Set up a matrix
-	double m[3][3] = { { a_x, b_x, c_x }, { a_y, b_y, c_y }, { 1, 1, 1 } };
+template <typename T> bool Collinear(const BasicVert<T>& a, const BasicVert<T>& b, const BasicVert<T>& c)
+{
+	// Returns true if the three points are exactly on one line
+	return OrientSign(a.x(), a.y(), b.x(), b.y(), c.x(), c.y()) == 0;
+}
 
-	// Return true if our determinant is positive
-	return Det3x3(m[0], m[1], m[2]) > 0;
+template <typename T> bool InDiametralCircle(const BasicVert<T>& a, const BasicVert<T>& b, const BasicVert<T>& c)
+{
+	// Returns true if c is strictly inside the circle with ab as its diameter, which is when the angle at c is obtuse
+	// Integers get 64 bits, which holds the dot product exactly under EXACT_COORD_LIMIT, and 128 past it
+	typedef typename std::conditional<std::is_integral<T>::value, std::int64_t, double>::type Wide;
+
+	Wide ax = (Wide)a.x() - c.x();
+	Wide ay = (Wide)a.y() - c.y();
+	Wide bx = (Wide)b.x() - c.x();
+	Wide by = (Wide)b.y() - c.y();
+
+	// Past the limit a product can need 65 bits, so add them up in 128
+	if (std::is_integral<T>::value &&
+		(ExactRangeBits(a.x()) | ExactRangeBits(a.y()) | ExactRangeBits(b.x()) | ExactRangeBits(b.y()) | ExactRangeBits(c.x()) | ExactRangeBits(c.y())) >= EXACT_RANGE_BITS)
+	{
+		return WideSign(WideMultiply((std::int64_t)ax, (std::int64_t)bx) + WideMultiply((std::int64_t)ay, (std::int64_t)by)) < 0;
+	}
+
+	return ax * bx + ay * by < 0;
 }
 
-bool LeftOf(Edge* e, Vert* z)
-{ 
+template <typename T> bool LeftOf(const BasicQuadEdgeMesh<T>& mesh, EdgeRef e, const BasicVert<T>& z)
+{
 	// Return true if the point is left of the oriented line defined by the edge
-	return CCW(z, e->origin(), e->destination()); 
+	return CCW(z, mesh.origin(e), mesh.destination(e));
 };
 
-bool RightOf(Edge* e, Vert* z)
-{ 
+template <typename T> bool RightOf(const BasicQuadEdgeMesh<T>& mesh, EdgeRef e, const BasicVert<T>& z)
+{
 	// Return true if the point is right of the oriented line defined by the edge
-	return CCW(z, e->destination(), e->origin()); 
+	return CCW(z, mesh.destination(e), mesh.origin(e));
 };
 
-bool Valid(Edge* e, Edge* base_edge)
+template <typename T> bool Valid(const BasicQuadEdgeMesh<T>& mesh, EdgeRef e, EdgeRef base_edge)
 {
 	// Return false if e ends beneath the base edge, which disqualifies it for candidacy when we zip the hulls
-	return RightOf(base_edge, e->destination()); 
+	return RightOf(mesh, base_edge, mesh.destination(e));
+};
+
+template <typename T> Vert Circumcenter(const BasicVert<T>& a, const BasicVert<T>& b, const BasicVert<T>& c)
+{
+	// Work in doubles so integer coordinates don't overflow when we square them
+	double ax = a.x();
+	double ay = a.y();
+	double bx = b.x();
+	double by = b.y();
+	double cx = c.x();
+	double cy = c.y();
+
+	double alen = ax * ax + ay * ay;
+	double blen = bx * bx + by * by;
+	double clen = cx * cx + cy * cy;
+
+	double d = 2 * (ax * (by - cy) + bx * (cy - ay) + cx * (ay - by));
+
+	float x = (float)((alen * (by - cy) + blen * (cy - ay) + clen * (ay - by)) / d);
+	float y = (float)((alen * (cx - bx) + blen * (ax - cx) + clen * (bx - ax)) / d);
+
+	return Vert(x, y);
+}
+
+//	--------------------------------------------------------
+//	Walking the mesh
+//	--------------------------------------------------------
+
+// Where a walk toward a point ended up
+enum Location
+{
+	ON_VERTEX,																		// e leaves the Vert that's already there
+	IN_FACE,																		// x is in the triangle left of e, maybe on its boundary
+	OUTSIDE_HULL																	// e is a hull edge with the outside on its left, and x is strictly left of it
 };
 
-sf::Vector2f Circumcenter(Vert* a, Vert* b, Vert* c)
+template <typename T> bool LexLess(const BasicVert<T>& p, const BasicVert<T>& q)
 {
-	float d = 2 * (a->x() * (b->y() - c->y()) + b->x() * (c->y() - a->y()) + c->x() * (a->y() - b->y()));
+	return (p.x() < q.x()) || (p.x() == q.x() && p.y() < q.y());
+}
 
-	float x = (float)(a->lengthsquared() * (b->y() - c->y()) + b->lengthsquared() * (c->y() - a->y()) + c->lengthsquared() * (a->y() - b->y())) / d;
-	float y = (float)(a->lengthsquared() * (c->x() - b->x()) + b->lengthsquared() * (a->x() - c->x()) + c->lengthsquared() * (b->x() - a->x())) / d;
+template <typename T> bool OutsideLeft(const BasicQuadEdgeMesh<T>& mesh, EdgeRef e)
+{
+	// Every face inside the hull is a counterclockwise triangle, so if the corner after e isn't left of it,
+	// the face on e's left must be the outside
+	return !LeftOf(mesh, e, mesh.destination(mesh.Lnext(e)));
+}
 
-	return sf::Vector2f(x, y);
+template <typename T> Location WalkTo(const BasicQuadEdgeMesh<T>& mesh, const BasicVert<T>& x, EdgeRef& e)
+{
+	// Walk from e toward x a triangle at a time, always crossing an edge that x is on the far side of
+	// In a Delaunay triangulation this walk can't go in circles, whichever edge we pick (Edelsbrunner)
+	// The mesh needs at least one triangle; with none, there's nothing to walk across
+	if (RightOf(mesh, e, x))
+	{
+		e = Sym(e);
+	}
+
+	while (true)
+	{
+		// x is never right of e from here on
+		const BasicVert<T>& org = mesh.origin(e);
+		const BasicVert<T>& dest = mesh.destination(e);
+
+		if (org.x() == x.x() && org.y() == x.y())
+		{
+			return ON_VERTEX;
+		}
+		if (dest.x() == x.x() && dest.y() == x.y())
+		{
+			e = Sym(e);
+			return ON_VERTEX;
+		}
+		if (OutsideLeft(mesh, e))
+		{
+			if (LeftOf(mesh, e, x))
+			{
+				return OUTSIDE_HULL;
+			}
+
+			// x is on the line through this hull edge, so it's either on the edge or off one end of it
+			// Points on a line are in the same order along it as they are lexicographically
+			bool forward = LexLess(org, dest);
+			bool past_dest = forward ? LexLess(dest, x) : LexLess(x, dest);
+			bool before_org = forward ? LexLess(x, org) : LexLess(org, x);
+
+			if (!past_dest && !before_org)
+			{
+				// On it; that's the boundary of the triangle on the other side
+				e = Sym(e);
+				return IN_FACE;
+			}
+
+			// Off the end; slide along the hull toward it, and we'll either see it or land on it
+			e = past_dest ? mesh.Lnext(e) : mesh.Lprev(e);
+			continue;
+		}
+
+		EdgeRef f1 = mesh.Lnext(e);
+		EdgeRef f2 = mesh.Lnext(f1);
+		const BasicVert<T>& apex = mesh.origin(f2);
+
+		if (apex.x() == x.x() && apex.y() == x.y())
+		{
+			e = f2;
+			return ON_VERTEX;
+		}
+
+		if (RightOf(mesh, f1, x))
+		{
+			e = Sym(f1);
+		}
+		else if (RightOf(mesh, f2, x))
+		{
+			e = Sym(f2);
+		}
+		else
+		{
+			return IN_FACE;
+		}
+	}
 }
 
 //	--------------------------------------------------------
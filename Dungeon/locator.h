@@ -0,0 +1,326 @@
+//	--------------------------------------------------------
+//	LOCATOR.H
+//	--------------------------------------------------------
+//	Contains point location and nearest-neighbor queries that walk a finished triangulation
+//	No k-d tree; the triangulation already knows who's next to whom
+//	--------------------------------------------------------
+
+#ifndef LOCATOR_H
+#define LOCATOR_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "topology.h"
+#include "radix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+// Every query starts from wherever the last one ended, so a run of queries that are close together is nearly free
+// Queries that jump around start from a coarse grid of Verts instead, so the walk is only ever a few steps (jump and walk)
+// It reads the mesh and never writes it; build a new one after you edit the triangulation
+template <typename T>
+class BasicLocator
+{
+public:
+	typedef BasicVert<T>						VertType;
+	typedef BasicQuadEdgeMesh<T>				MeshType;
+
+private:
+	const MeshType*								mesh_;
+
+	// Where the last query ended up
+	EdgeRef										last_;
+
+	// With no edges at all there's no walking to do; this is the only Vert there is, or NIL
+	VertRef										lone_;
+
+	// No triangles means point location has nothing to find
+	bool										flat_;
+
+	// One Vert from each cell of a grid over the Verts, about four Verts to a cell; NIL for empty cells
+	std::vector<VertRef>						hints_;
+	std::uint32_t								gridSize_;
+	double										gridX_;
+	double										gridY_;
+	double										gridScale_;
+
+	// For k-nearest: a heap of Verts by distance, and a stamp per Vert so we can tell who we've seen without clearing
+	std::vector<RadixItem>						frontier_;
+	std::vector<std::uint32_t>					stamps_;
+	std::uint32_t								stamp_;
+
+	std::uint64_t								DistanceTo(VertRef v, const VertType& x) const;
+	std::uint32_t								Cell(double x, double y) const;
+	void										BuildHints(BasicDelaunay<T>& del);
+	VertRef										StartVert(const VertType& x) const;
+
+public:
+	// Builds the triangulation first if nobody has yet
+	BasicLocator(BasicDelaunay<T>& del);
+
+	// Walk to the triangle holding (x, y); it ends up left of e, maybe on its boundary
+	// Returns false if (x, y) is outside the hull, and then it's strictly left of the hull edge e instead
+	// A flat triangulation has no triangles, so that's always false, with e leaving the nearest Vert
+	bool										Locate(T x, T y, EdgeRef& e);
+
+	// The closest Vert to (x, y), by walking downhill; NIL if there aren't any
+	// That's exact on a Delaunay triangulation: a Vert that isn't the closest always has a neighbor that's closer
+	VertRef										Nearest(T x, T y);
+
+	// The k closest Verts, closest first, by growing outward through neighbors from the closest
+	// Whoever's next closest always borders someone already found, so we never have to look further than one ring out
+	void										Nearest(T x, T y, std::size_t k, std::vector<VertRef>& out);
+};
+
+typedef BasicLocator<float>						Locator;
+typedef BasicLocator<int>						IntLocator;
+
+//	--------------------------------------------------------
+//	Constructor
+//	--------------------------------------------------------
+
+template <typename T>
+BasicLocator<T>::BasicLocator(BasicDelaunay<T>& del) : mesh_(&del.mesh()), last_(NIL), lone_(NIL), flat_(true), stamp_(0)
+{
+	del.GetTriangulation();
+
+	for (VertRef v = 0; v < mesh_->vertCount(); v++)
+	{
+		if (del.removed(v))
+		{
+			continue;
+		}
+
+		if (mesh_->edge(v) != NIL)
+		{
+			last_ = mesh_->edge(v);
+			break;
+		}
+
+		lone_ = (lone_ == NIL) ? v : lone_;
+	}
+
+	// Any edge of a triangulation with triangles in it has one on at least one side
+	if (last_ != NIL)
+	{
+		flat_ = OutsideLeft(*mesh_, last_) && OutsideLeft(*mesh_, Sym(last_));
+		BuildHints(del);
+	}
+}
+
+//	--------------------------------------------------------
+//	Helpers
+//	--------------------------------------------------------
+
+template <typename T>
+std::uint64_t BasicLocator<T>::DistanceTo(VertRef v, const VertType& x) const
+{
+	const VertType& p = mesh_->vert(v);
+	return DistanceKey(p.x(), p.y(), x.x(), x.y());
+}
+
+template <typename T>
+std::uint32_t BasicLocator<T>::Cell(double x, double y) const
+{
+	double cx = (x - gridX_) * gridScale_;
+	double cy = (y - gridY_) * gridScale_;
+	std::uint32_t ix = (cx <= 0.0) ? 0 : (cx >= gridSize_ - 1) ? gridSize_ - 1 : (std::uint32_t)cx;
+	std::uint32_t iy = (cy <= 0.0) ? 0 : (cy >= gridSize_ - 1) ? gridSize_ - 1 : (std::uint32_t)cy;
+	return iy * gridSize_ + ix;
+}
+
+template <typename T>
+void BasicLocator<T>::BuildHints(BasicDelaunay<T>& del)
+{
+	double min_x = 0.0;
+	double min_y = 0.0;
+	double max_x = 0.0;
+	double max_y = 0.0;
+	std::uint32_t live = 0;
+
+	for (VertRef v = 0; v < mesh_->vertCount(); v++)
+	{
+		if (del.removed(v) || mesh_->edge(v) == NIL)
+		{
+			continue;
+		}
+
+		const VertType& p = mesh_->vert(v);
+		min_x = (live == 0 || p.x() < min_x) ? p.x() : min_x;
+		min_y = (live == 0 || p.y() < min_y) ? p.y() : min_y;
+		max_x = (live == 0 || p.x() > max_x) ? p.x() : max_x;
+		max_y = (live == 0 || p.y() > max_y) ? p.y() : max_y;
+		live++;
+	}
+
+	double extent = std::max(max_x - min_x, max_y - min_y);
+	gridSize_ = std::max(1u, (std::uint32_t)std::sqrt(live / 4.0));
+	gridX_ = min_x;
+	gridY_ = min_y;
+	gridScale_ = (extent > 0.0) ? gridSize_ / extent : 0.0;
+	hints_.assign(gridSize_ * gridSize_, NIL);
+
+	// First come, first served; any Vert in the cell is a few steps from anything else in it
+	for (VertRef v = 0; v < mesh_->vertCount(); v++)
+	{
+		if (!del.removed(v) && mesh_->edge(v) != NIL)
+		{
+			const VertType& p = mesh_->vert(v);
+			std::uint32_t c = Cell(p.x(), p.y());
+			hints_[c] = (hints_[c] == NIL) ? v : hints_[c];
+		}
+	}
+}
+
+template <typename T>
+VertRef BasicLocator<T>::StartVert(const VertType& x) const
+{
+	// Whichever's closer: where we were last time, or the grid's pick for where we're going
+	VertRef last = mesh_->Org(last_);
+	VertRef hint = hints_[Cell(x.x(), x.y())];
+
+	if (hint != NIL && DistanceTo(hint, x) < DistanceTo(last, x))
+	{
+		return hint;
+	}
+	return last;
+}
+
+//	--------------------------------------------------------
+//	Queries
+//	--------------------------------------------------------
+
+template <typename T>
+bool BasicLocator<T>::Locate(T x, T y, EdgeRef& e)
+{
+	if (last_ == NIL || flat_)
+	{
+		VertRef v = Nearest(x, y);
+		e = (v == NIL) ? NIL : mesh_->edge(v);
+		return false;
+	}
+
+	// The same walk the triangulator uses for inserting, starting from wherever's closer
+	VertType p(x, y);
+	e = mesh_->edge(StartVert(p));
+	Location where = WalkTo(*mesh_, p, e);
+
+	// Landing on a Vert is landing on a triangle corner; if the outside's left of e, the triangle's just clockwise of it
+	if (where == ON_VERTEX && OutsideLeft(*mesh_, e))
+	{
+		e = mesh_->Oprev(e);
+	}
+
+	last_ = e;
+	return where != OUTSIDE_HULL;
+}
+
+template <typename T>
+VertRef BasicLocator<T>::Nearest(T x, T y)
+{
+	if (last_ == NIL)
+	{
+		return lone_;
+	}
+
+	VertType p(x, y);
+	VertRef v = StartVert(p);
+	std::uint64_t best = DistanceTo(v, p);
+
+	// Step to the closest neighbor until nobody around us is any closer
+	while (true)
+	{
+		VertRef next = v;
+		EdgeRef first = mesh_->edge(v);
+		EdgeRef e = first;
+		do
+		{
+			VertRef w = mesh_->Dest(e);
+			std::uint64_t d = DistanceTo(w, p);
+			if (d < best)
+			{
+				best = d;
+				next = w;
+			}
+			e = mesh_->Onext(e);
+		} while (e != first);
+
+		if (next == v)
+		{
+			break;
+		}
+		v = next;
+	}
+
+	last_ = mesh_->edge(v);
+	return v;
+}
+
+template <typename T>
+void BasicLocator<T>::Nearest(T x, T y, std::size_t k, std::vector<VertRef>& out)
+{
+	out.clear();
+
+	VertRef start = Nearest(x, y);
+	if (k == 0 || start == NIL)
+	{
+		return;
+	}
+
+	if (last_ == NIL)
+	{
+		out.push_back(start);
+		return;
+	}
+
+	// A new stamp for this query; when they wrap around, wipe the old ones so none of them look current
+	stamps_.resize(mesh_->vertCount(), 0);
+	if (++stamp_ == 0)
+	{
+		std::fill(stamps_.begin(), stamps_.end(), 0);
+		stamp_ = 1;
+	}
+
+	VertType p(x, y);
+	auto further = [](const RadixItem& a, const RadixItem& b) { return a.key > b.key; };
+
+	frontier_.clear();
+	RadixItem item = { DistanceTo(start, p), start };
+	frontier_.push_back(item);
+	stamps_[start] = stamp_;
+
+	while (!frontier_.empty() && out.size() < k)
+	{
+		std::pop_heap(frontier_.begin(), frontier_.end(), further);
+		VertRef v = frontier_.back().index;
+		frontier_.pop_back();
+		out.push_back(v);
+
+		EdgeRef first = mesh_->edge(v);
+		EdgeRef e = first;
+		do
+		{
+			VertRef w = mesh_->Dest(e);
+			if (stamps_[w] != stamp_)
+			{
+				stamps_[w] = stamp_;
+				RadixItem next = { DistanceTo(w, p), w };
+				frontier_.push_back(next);
+				std::push_heap(frontier_.begin(), frontier_.end(), further);
+			}
+			e = mesh_->Onext(e);
+		} while (e != first);
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
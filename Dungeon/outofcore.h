@@ -0,0 +1,503 @@
+//	--------------------------------------------------------
+//	OUTOFCORE.H
+//	--------------------------------------------------------
+//	Contains a triangulator for point sets too big to hold in memory at once
+//	Points come in from a file, get cut into vertical strips on disk, and triangles go out to another file as they're finished
+//	--------------------------------------------------------
+
+#ifndef OUTOFCORE_H
+#define OUTOFCORE_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "topology.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+// The strips are swept left to right
+// Each one gets triangulated together with the seam: whatever points from earlier strips still have unfinished triangles, plus the hull
+// A triangle is finished once its circumcircle lies entirely left of the next strip, since nothing to come can land inside it
+// Finished triangles are written out and their points dropped, so memory is a strip plus the seam, however many points there are
+//
+// Re-triangulating the seam on its own fills in the ground we already wrote out with triangles that were never really there
+// The frontier fences that ground off: every edge with finished ground on its left and unfinished ground (or nothing) on its right
+// Those edges belong to finished triangles, so they never go away, and whatever is on their left side is skipped
+//
+// Input is raw pairs of T, x then y; output is three uint32 point indices per triangle, counterclockwise, in no particular order
+// It's the same triangulation GetTriangulation would give, ties and all, since the predicates break ties the same way everywhere
+template <typename T>
+class BasicStripTriangulator
+{
+public:
+	typedef BasicVert<T>						VertType;
+
+	// A point and where it came from in the input; this is what the strip files hold
+	struct Record
+	{
+		T										x;
+		T										y;
+		std::uint32_t							source;
+	};
+
+private:
+	// Where the strip files go; they're named after this, and deleted as soon as they've been read
+	std::string									scratch_;
+	std::size_t									stripPoints_;
+
+	// Strip k holds every point with bounds_[k - 1] <= x < bounds_[k]
+	std::vector<T>								bounds_;
+
+	// Points from earlier strips that we still need
+	std::vector<Record>							seam_;
+
+	// Edges with finished ground on their left, as (from << 32) | to in input indices
+	std::unordered_set<std::uint64_t>			frontier_;
+
+	// Scratch for each strip, kept around so the next one doesn't allocate
+	std::vector<Record>							points_;
+	std::vector<VertType>						verts_;
+	TriangulationExport							export_;
+	std::unordered_map<std::uint64_t, std::uint32_t>	sides_;
+	std::vector<std::uint8_t>					state_;
+	std::vector<std::uint32_t>					queue_;
+	std::vector<bool>							keep_;
+
+	// How it went
+	std::size_t									strips_;
+	std::size_t									peakPoints_;
+	std::uint64_t								triangles_;
+
+	static std::uint64_t						Key(std::uint32_t from, std::uint32_t to)		{ return ((std::uint64_t)from << 32) | to; };
+	static bool									Finished(const VertType& a, const VertType& b, const VertType& c, double limit);
+
+	std::string									StripPath(std::size_t k) const;
+	void										RemoveStrips();
+	bool										Partition(const char* pointsPath);
+	bool										Flush(std::vector<Record>& buffer, std::size_t k);
+	bool										Stitch(double limit, std::ofstream& out);
+
+public:
+	// stripPoints is roughly how many points each strip gets, which is most of the memory we'll use
+	BasicStripTriangulator(const char* scratch, std::size_t stripPoints = 1 << 20);
+
+	// Returns false if a file couldn't be read or written, or the points file ends partway through a point
+	// The strip files are gone afterward either way
+	bool										Triangulate(const char* pointsPath, const char* trianglesPath);
+
+	std::size_t									strips() const									{ return strips_; };
+	std::size_t									peakPoints() const								{ return peakPoints_; };
+	std::uint64_t								triangleCount() const							{ return triangles_; };
+};
+
+typedef BasicStripTriangulator<float>			StripTriangulator;
+typedef BasicStripTriangulator<int>				IntStripTriangulator;
+
+// Points per read, points sampled for picking the strip boundaries, and points buffered per strip before they go to disk
+const std::size_t STRIP_READ_CHUNK				= 1 << 16;
+const std::size_t STRIP_SAMPLE_SIZE				= 1 << 16;
+const std::size_t STRIP_WRITE_BUFFER			= 1 << 10;
+
+// What became of each triangle in a strip
+const std::uint8_t STRIP_LIVE					= 0;		// Real, and something to come might still change it
+const std::uint8_t STRIP_OLD					= 1;		// On ground we've already written out
+const std::uint8_t STRIP_DONE					= 2;		// Real, finished, and written out just now
+
+//	--------------------------------------------------------
+//	Constructor
+//	--------------------------------------------------------
+
+template <typename T>
+BasicStripTriangulator<T>::BasicStripTriangulator(const char* scratch, std::size_t stripPoints) : scratch_(scratch), stripPoints_(std::max<std::size_t>(stripPoints, 3)), strips_(0), peakPoints_(0), triangles_(0)
+{
+
+}
+
+//	--------------------------------------------------------
+//	Helpers
+//	--------------------------------------------------------
+
+template <typename T>
+std::string BasicStripTriangulator<T>::StripPath(std::size_t k) const
+{
+	return scratch_ + ".strip" + std::to_string(k);
+}
+
+template <typename T>
+void BasicStripTriangulator<T>::RemoveStrips()
+{
+	// Some of these may never have been made, or already be gone, and that's fine
+	for (std::size_t k = 0; k < strips_; k++)
+	{
+		std::remove(StripPath(k).c_str());
+	}
+}
+
+template <typename T>
+bool BasicStripTriangulator<T>::Finished(const VertType& a, const VertType& b, const VertType& c, double limit)
+{
+	// True if the circumcircle is strictly left of x = limit
+	// Getting this wrong one way only keeps a triangle around for another strip, so we're generous with the error and never exact
+	double bx = (double)b.x() - a.x();
+	double by = (double)b.y() - a.y();
+	double cx = (double)c.x() - a.x();
+	double cy = (double)c.y() - a.y();
+
+	// Nearly flat triangles have circumcenters we can't pin down; those wait until the end
+	double det = bx * cy - by * cx;
+	if (!(std::fabs(det) > 1024.0 * EPSILON * (std::fabs(bx * cy) + std::fabs(by * cx))))
+	{
+		return false;
+	}
+
+	double b2 = bx * bx + by * by;
+	double c2 = cx * cx + cy * cy;
+	double ox = (cy * b2 - by * c2) / (2.0 * det);
+	double oy = (bx * c2 - cx * b2) / (2.0 * det);
+	double r = std::sqrt(ox * ox + oy * oy);
+
+	double err = 8.0 * EPSILON * (std::fabs(cy) * b2 + std::fabs(by) * c2 + std::fabs(bx) * c2 + std::fabs(cx) * b2) / std::fabs(det)
+			   + 4.0e-3 * (std::fabs(ox) + std::fabs(oy))
+			   + 64.0 * EPSILON * (std::fabs((double)a.x()) + std::fabs(limit));
+
+	return a.x() + ox + r + 2.0 * err < limit;
+}
+
+//	--------------------------------------------------------
+//	Cutting the input into strips
+//	--------------------------------------------------------
+
+template <typename T>
+bool BasicStripTriangulator<T>::Flush(std::vector<Record>& buffer, std::size_t k)
+{
+	if (buffer.empty())
+	{
+		return true;
+	}
+
+	// Opened and closed every time, so there's never more than one strip file open however many strips there are
+	std::ofstream out(StripPath(k).c_str(), std::ios::binary | std::ios::app);
+	out.write((const char*)buffer.data(), buffer.size() * sizeof(Record));
+	buffer.clear();
+	return out.good();
+}
+
+template <typename T>
+bool BasicStripTriangulator<T>::Partition(const char* pointsPath)
+{
+	std::vector<T> chunk(STRIP_READ_CHUNK * 2);
+
+	// First pass: count them, and keep a fixed-size random sample of x to pick boundaries from
+	std::ifstream in(pointsPath, std::ios::binary);
+	if (!in)
+	{
+		return false;
+	}
+
+	std::vector<T> sample;
+	std::mt19937 rng(0);
+	std::uint64_t n = 0;
+
+	while (in)
+	{
+		in.read((char*)chunk.data(), chunk.size() * sizeof(T));
+		std::size_t got = in.gcount() / (2 * sizeof(T));
+
+		// Every chunk but the last is whole points, so a leftover here means the file was cut off or isn't points
+		if (in.gcount() % (2 * sizeof(T)) != 0)
+		{
+			return false;
+		}
+
+		for (std::size_t i = 0; i < got; i++, n++)
+		{
+			if (sample.size() < STRIP_SAMPLE_SIZE)
+			{
+				sample.push_back(chunk[2 * i]);
+			}
+			else if (rng() % (n + 1) < STRIP_SAMPLE_SIZE)
+			{
+				sample[rng() % STRIP_SAMPLE_SIZE] = chunk[2 * i];
+			}
+		}
+	}
+
+	// Indices go out as uint32, same as VertRef
+	if (n >= NIL)
+	{
+		return false;
+	}
+
+	// Boundaries at even steps through the sorted sample; repeated x values all go in one strip, so no boundary repeats
+	std::size_t wanted = std::max<std::size_t>(1, (std::size_t)((n + stripPoints_ - 1) / stripPoints_));
+	std::sort(sample.begin(), sample.end());
+	bounds_.clear();
+
+	for (std::size_t k = 1; k < wanted; k++)
+	{
+		T b = sample[k * sample.size() / wanted];
+		if (bounds_.empty() || bounds_.back() < b)
+		{
+			bounds_.push_back(b);
+		}
+	}
+
+	strips_ = bounds_.size() + 1;
+
+	// Second pass: deal them out
+	for (std::size_t k = 0; k < strips_; k++)
+	{
+		std::ofstream out(StripPath(k).c_str(), std::ios::binary | std::ios::trunc);
+		if (!out)
+		{
+			return false;
+		}
+	}
+
+	std::vector<std::vector<Record>> buffers(strips_);
+	in.clear();
+	in.seekg(0);
+	std::uint32_t index = 0;
+
+	while (in)
+	{
+		in.read((char*)chunk.data(), chunk.size() * sizeof(T));
+		std::size_t got = in.gcount() / (2 * sizeof(T));
+
+		for (std::size_t i = 0; i < got; i++, index++)
+		{
+			Record r = { chunk[2 * i], chunk[2 * i + 1], index };
+			std::size_t k = std::upper_bound(bounds_.begin(), bounds_.end(), r.x) - bounds_.begin();
+			buffers[k].push_back(r);
+
+			if (buffers[k].size() >= STRIP_WRITE_BUFFER && !Flush(buffers[k], k))
+			{
+				return false;
+			}
+		}
+	}
+
+	for (std::size_t k = 0; k < strips_; k++)
+	{
+		if (!Flush(buffers[k], k))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	--------------------------------------------------------
+//	Sweeping
+//	--------------------------------------------------------
+
+template <typename T>
+bool BasicStripTriangulator<T>::Stitch(double limit, std::ofstream& out)
+{
+	// points_ is the seam followed by the new strip
+	peakPoints_ = std::max(peakPoints_, points_.size());
+
+	verts_.resize(points_.size());
+	for (std::size_t i = 0; i < points_.size(); i++)
+	{
+		verts_[i] = VertType(points_[i].x, points_[i].y);
+	}
+
+	BasicDelaunay<T> del(verts_.data(), verts_.size(), false);
+	del.Export(export_);
+
+	const std::vector<VertRef>& tris = export_.triangles;
+	std::uint32_t m = tris.size() / 3;
+
+	// Which triangle is on the left of each directed edge, in input indices so it matches the frontier
+	sides_.clear();
+	sides_.reserve(tris.size());
+
+	for (std::uint32_t t = 0; t < m; t++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			std::uint32_t a = points_[del.source(tris[3 * t + j])].source;
+			std::uint32_t b = points_[del.source(tris[3 * t + (j + 1) % 3])].source;
+			sides_[Key(a, b)] = t;
+		}
+	}
+
+	// Flood out from the finished side of every frontier edge, without crossing the frontier; all of that is old ground
+	state_.assign(m, STRIP_LIVE);
+	queue_.clear();
+
+	for (auto f = frontier_.begin(); f != frontier_.end(); f++)
+	{
+		auto side = sides_.find(*f);
+		if (side != sides_.end() && state_[side->second] == STRIP_LIVE)
+		{
+			state_[side->second] = STRIP_OLD;
+			queue_.push_back(side->second);
+		}
+	}
+
+	while (!queue_.empty())
+	{
+		std::uint32_t t = queue_.back();
+		queue_.pop_back();
+
+		for (int j = 0; j < 3; j++)
+		{
+			std::uint32_t a = points_[del.source(tris[3 * t + j])].source;
+			std::uint32_t b = points_[del.source(tris[3 * t + (j + 1) % 3])].source;
+
+			if (frontier_.count(Key(a, b)) > 0)
+			{
+				continue;
+			}
+
+			auto across = sides_.find(Key(b, a));
+			if (across != sides_.end() && state_[across->second] == STRIP_LIVE)
+			{
+				state_[across->second] = STRIP_OLD;
+				queue_.push_back(across->second);
+			}
+		}
+	}
+
+	// Write out whatever the strips still to come can't reach
+	bool last = (limit == std::numeric_limits<double>::infinity());
+
+	for (std::uint32_t t = 0; t < m; t++)
+	{
+		if (state_[t] != STRIP_LIVE)
+		{
+			continue;
+		}
+
+		VertRef u = tris[3 * t];
+		VertRef v = tris[3 * t + 1];
+		VertRef w = tris[3 * t + 2];
+
+		if (last || Finished(del.mesh().vert(u), del.mesh().vert(v), del.mesh().vert(w), limit))
+		{
+			std::uint32_t ids[3] = { points_[del.source(u)].source, points_[del.source(v)].source, points_[del.source(w)].source };
+			out.write((const char*)ids, sizeof(ids));
+			state_[t] = STRIP_DONE;
+			triangles_++;
+		}
+	}
+
+	// The new frontier is every edge of finished ground that faces unfinished ground or the outside
+	frontier_.clear();
+
+	for (std::uint32_t t = 0; t < m; t++)
+	{
+		if (state_[t] == STRIP_LIVE)
+		{
+			continue;
+		}
+
+		for (int j = 0; j < 3; j++)
+		{
+			std::uint32_t a = points_[del.source(tris[3 * t + j])].source;
+			std::uint32_t b = points_[del.source(tris[3 * t + (j + 1) % 3])].source;
+
+			auto across = sides_.find(Key(b, a));
+			if (across == sides_.end() || state_[across->second] == STRIP_LIVE)
+			{
+				frontier_.insert(Key(a, b));
+			}
+		}
+	}
+
+	// Keep the corners of everything unfinished, and the hull, since the next strip can still hang triangles off it
+	keep_.assign(points_.size(), false);
+
+	for (std::uint32_t t = 0; t < m; t++)
+	{
+		if (state_[t] == STRIP_LIVE)
+		{
+			keep_[del.source(tris[3 * t])] = true;
+			keep_[del.source(tris[3 * t + 1])] = true;
+			keep_[del.source(tris[3 * t + 2])] = true;
+		}
+	}
+
+	for (std::size_t i = 0; i < export_.hull.size(); i++)
+	{
+		keep_[del.source(export_.hull[i])] = true;
+	}
+
+	seam_.clear();
+	for (std::size_t i = 0; i < points_.size(); i++)
+	{
+		if (keep_[i])
+		{
+			seam_.push_back(points_[i]);
+		}
+	}
+
+	return out.good();
+}
+
+template <typename T>
+bool BasicStripTriangulator<T>::Triangulate(const char* pointsPath, const char* trianglesPath)
+{
+	seam_.clear();
+	frontier_.clear();
+	strips_ = 0;
+	peakPoints_ = 0;
+	triangles_ = 0;
+
+	// strips_ only gets set right before the strip files are made, so this catches whatever got made before it failed
+	if (!Partition(pointsPath))
+	{
+		RemoveStrips();
+		return false;
+	}
+
+	std::ofstream out(trianglesPath, std::ios::binary | std::ios::trunc);
+	bool ok = out.good();
+
+	for (std::size_t k = 0; k < strips_; k++)
+	{
+		std::string path = StripPath(k);
+
+		if (ok)
+		{
+			std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+			std::size_t count = in ? (std::size_t)in.tellg() / sizeof(Record) : 0;
+			in.seekg(0);
+
+			points_ = seam_;
+			points_.resize(seam_.size() + count);
+			in.read((char*)(points_.data() + seam_.size()), count * sizeof(Record));
+			ok = in.good() || count == 0;
+
+			// Everything to come is at or right of the next boundary
+			double limit = (k + 1 < strips_) ? (double)bounds_[k] : std::numeric_limits<double>::infinity();
+			ok = ok && Stitch(limit, out);
+		}
+
+		std::remove(path.c_str());
+	}
+
+	return ok && out.good();
+}
+
+//	--------------------------------------------------------
+
+#endif
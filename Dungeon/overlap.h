@@ -0,0 +1,303 @@
+//	--------------------------------------------------------
+//	OVERLAP.H
+//	--------------------------------------------------------
+//	Tests one rect against a block of rects a handful at a time, for the drift and the corridors
+//	--------------------------------------------------------
+
+#ifndef OVERLAP_H
+#define OVERLAP_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "rect.h"
+
+#include <algorithm>
+#include <cstdint>
+
+// Picked when compiling rather than when running: build with AVX2 on (-mavx2, /arch:AVX2) to get eight lanes
+// Every x64 compiler has SSE2, so that's four lanes; anything else goes one at a time
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define OVERLAP_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OVERLAP_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+//	--------------------------------------------------------
+//	Masks
+//	--------------------------------------------------------
+
+// Every function here looks at rects[first, first + count) and sets bit k of what it returns if rects[first + k] passes,
+// so count can't be more than OVERLAP_BLOCK; callers walk longer lists a block at a time
+// Same answers as sf::Rect::intersects for rects with positive sizes
+const std::size_t							OVERLAP_BLOCK = 32;
+
+// The rects that overlap r
+std::uint32_t								OverlapMask(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count);
+
+// Same, and how far each one overlaps r across and down, which is what DriftVector wants
+// Lanes that miss get written too, with nonsense in them
+std::uint32_t								OverlapExtents(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count, int* across, int* down);
+
+// The rects a corridor running through r cuts: strictly inside r along the corridor, and overlapping r across it
+std::uint32_t								CrossingMask(const Rect& r, bool horizontal, const RectArrays& rects, std::size_t first, std::size_t count);
+
+// Which bit is the lowest one set; mask can't be zero
+inline int									LowestBit(std::uint32_t mask);
+
+//	--------------------------------------------------------
+//	One lane
+//	--------------------------------------------------------
+
+// A rect's span [start, end) along one axis against the bounds (lo, hi) on it:
+// inside means strictly between them, otherwise it just has to overlap [lo, hi)
+template <bool Inside>
+inline bool OverlapAlong(int lo, int hi, int start, int end)
+{
+	return Inside ? (lo < start && end < hi) : (start < hi && lo < end);
+}
+
+template <bool InsideX, bool InsideY>
+std::uint32_t OverlapScalar(int x0, int x1, int y0, int y1, const RectArrays& rects, std::size_t first, std::size_t count, std::size_t k, std::uint32_t mask)
+{
+	for (; k < count; k++)
+	{
+		std::size_t i = first + k;
+
+		if (OverlapAlong<InsideX>(x0, x1, rects.left[i], rects.left[i] + rects.width[i]) &&
+			OverlapAlong<InsideY>(y0, y1, rects.top[i], rects.top[i] + rects.height[i]))
+		{
+			mask |= 1u << k;
+		}
+	}
+
+	return mask;
+}
+
+//	--------------------------------------------------------
+//	Lots of lanes
+//	--------------------------------------------------------
+
+#if defined(OVERLAP_AVX2)
+
+const std::size_t							OVERLAP_LANES = 8;
+
+template <bool Inside>
+inline __m256i OverlapAlongLanes(__m256i lo, __m256i hi, __m256i start, __m256i end)
+{
+	return Inside ? _mm256_and_si256(_mm256_cmpgt_epi32(start, lo), _mm256_cmpgt_epi32(hi, end)) :
+		_mm256_and_si256(_mm256_cmpgt_epi32(hi, start), _mm256_cmpgt_epi32(end, lo));
+}
+
+template <bool InsideX, bool InsideY>
+std::uint32_t OverlapLanes(int x0, int x1, int y0, int y1, const RectArrays& rects, std::size_t first, std::size_t count)
+{
+	const __m256i lx = _mm256_set1_epi32(x0);
+	const __m256i hx = _mm256_set1_epi32(x1);
+	const __m256i ly = _mm256_set1_epi32(y0);
+	const __m256i hy = _mm256_set1_epi32(y1);
+
+	std::uint32_t mask = 0;
+	std::size_t k = 0;
+
+	for (; k + OVERLAP_LANES <= count; k += OVERLAP_LANES)
+	{
+		std::size_t i = first + k;
+		__m256i left = _mm256_loadu_si256((const __m256i*)&rects.left[i]);
+		__m256i top = _mm256_loadu_si256((const __m256i*)&rects.top[i]);
+		__m256i right = _mm256_add_epi32(left, _mm256_loadu_si256((const __m256i*)&rects.width[i]));
+		__m256i bottom = _mm256_add_epi32(top, _mm256_loadu_si256((const __m256i*)&rects.height[i]));
+
+		__m256i hit = _mm256_and_si256(OverlapAlongLanes<InsideX>(lx, hx, left, right), OverlapAlongLanes<InsideY>(ly, hy, top, bottom));
+		mask |= (std::uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(hit)) << k;
+	}
+
+	return OverlapScalar<InsideX, InsideY>(x0, x1, y0, y1, rects, first, count, k, mask);
+}
+
+// The overlap runs from the bigger start to the smaller end, and it's only an overlap if that comes out positive both ways
+// Does as many whole lanes as fit and says how far it got
+inline std::size_t OverlapExtentLanes(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count, int* across, int* down, std::uint32_t& mask)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i left = _mm256_set1_epi32(r.left);
+	const __m256i top = _mm256_set1_epi32(r.top);
+	const __m256i right = _mm256_set1_epi32(r.left + r.width);
+	const __m256i bottom = _mm256_set1_epi32(r.top + r.height);
+
+	std::size_t k = 0;
+
+	for (; k + OVERLAP_LANES <= count; k += OVERLAP_LANES)
+	{
+		std::size_t i = first + k;
+		__m256i l = _mm256_loadu_si256((const __m256i*)&rects.left[i]);
+		__m256i t = _mm256_loadu_si256((const __m256i*)&rects.top[i]);
+		__m256i w = _mm256_sub_epi32(_mm256_min_epi32(right, _mm256_add_epi32(l, _mm256_loadu_si256((const __m256i*)&rects.width[i]))), _mm256_max_epi32(left, l));
+		__m256i h = _mm256_sub_epi32(_mm256_min_epi32(bottom, _mm256_add_epi32(t, _mm256_loadu_si256((const __m256i*)&rects.height[i]))), _mm256_max_epi32(top, t));
+
+		_mm256_storeu_si256((__m256i*)(across + k), w);
+		_mm256_storeu_si256((__m256i*)(down + k), h);
+
+		__m256i hit = _mm256_and_si256(_mm256_cmpgt_epi32(w, zero), _mm256_cmpgt_epi32(h, zero));
+		mask |= (std::uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(hit)) << k;
+	}
+
+	return k;
+}
+
+#elif defined(OVERLAP_SSE2)
+
+const std::size_t							OVERLAP_LANES = 4;
+
+template <bool Inside>
+inline __m128i OverlapAlongLanes(__m128i lo, __m128i hi, __m128i start, __m128i end)
+{
+	return Inside ? _mm_and_si128(_mm_cmpgt_epi32(start, lo), _mm_cmpgt_epi32(hi, end)) :
+		_mm_and_si128(_mm_cmpgt_epi32(hi, start), _mm_cmpgt_epi32(end, lo));
+}
+
+template <bool InsideX, bool InsideY>
+std::uint32_t OverlapLanes(int x0, int x1, int y0, int y1, const RectArrays& rects, std::size_t first, std::size_t count)
+{
+	const __m128i lx = _mm_set1_epi32(x0);
+	const __m128i hx = _mm_set1_epi32(x1);
+	const __m128i ly = _mm_set1_epi32(y0);
+	const __m128i hy = _mm_set1_epi32(y1);
+
+	std::uint32_t mask = 0;
+	std::size_t k = 0;
+
+	for (; k + OVERLAP_LANES <= count; k += OVERLAP_LANES)
+	{
+		std::size_t i = first + k;
+		__m128i left = _mm_loadu_si128((const __m128i*)&rects.left[i]);
+		__m128i top = _mm_loadu_si128((const __m128i*)&rects.top[i]);
+		__m128i right = _mm_add_epi32(left, _mm_loadu_si128((const __m128i*)&rects.width[i]));
+		__m128i bottom = _mm_add_epi32(top, _mm_loadu_si128((const __m128i*)&rects.height[i]));
+
+		__m128i hit = _mm_and_si128(OverlapAlongLanes<InsideX>(lx, hx, left, right), OverlapAlongLanes<InsideY>(ly, hy, top, bottom));
+		mask |= (std::uint32_t)_mm_movemask_ps(_mm_castsi128_ps(hit)) << k;
+	}
+
+	return OverlapScalar<InsideX, InsideY>(x0, x1, y0, y1, rects, first, count, k, mask);
+}
+
+// SSE2 has no min or max for 32-bit ints, so pick with a compare
+inline __m128i OverlapMin(__m128i a, __m128i b)
+{
+	__m128i greater = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+}
+
+inline __m128i OverlapMax(__m128i a, __m128i b)
+{
+	__m128i greater = _mm_cmpgt_epi32(a, b);
+	return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+
+inline std::size_t OverlapExtentLanes(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count, int* across, int* down, std::uint32_t& mask)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i left = _mm_set1_epi32(r.left);
+	const __m128i top = _mm_set1_epi32(r.top);
+	const __m128i right = _mm_set1_epi32(r.left + r.width);
+	const __m128i bottom = _mm_set1_epi32(r.top + r.height);
+
+	std::size_t k = 0;
+
+	for (; k + OVERLAP_LANES <= count; k += OVERLAP_LANES)
+	{
+		std::size_t i = first + k;
+		__m128i l = _mm_loadu_si128((const __m128i*)&rects.left[i]);
+		__m128i t = _mm_loadu_si128((const __m128i*)&rects.top[i]);
+		__m128i w = _mm_sub_epi32(OverlapMin(right, _mm_add_epi32(l, _mm_loadu_si128((const __m128i*)&rects.width[i]))), OverlapMax(left, l));
+		__m128i h = _mm_sub_epi32(OverlapMin(bottom, _mm_add_epi32(t, _mm_loadu_si128((const __m128i*)&rects.height[i]))), OverlapMax(top, t));
+
+		_mm_storeu_si128((__m128i*)(across + k), w);
+		_mm_storeu_si128((__m128i*)(down + k), h);
+
+		__m128i hit = _mm_and_si128(_mm_cmpgt_epi32(w, zero), _mm_cmpgt_epi32(h, zero));
+		mask |= (std::uint32_t)_mm_movemask_ps(_mm_castsi128_ps(hit)) << k;
+	}
+
+	return k;
+}
+
+#else
+
+const std::size_t							OVERLAP_LANES = 1;
+
+template <bool InsideX, bool InsideY>
+std::uint32_t OverlapLanes(int x0, int x1, int y0, int y1, const RectArrays& rects, std::size_t first, std::size_t count)
+{
+	return OverlapScalar<InsideX, InsideY>(x0, x1, y0, y1, rects, first, count, 0, 0);
+}
+
+// Nothing to do a lane at a time that the scalar loop doesn't do already
+inline std::size_t OverlapExtentLanes(const Rect&, const RectArrays&, std::size_t, std::size_t, int*, int*, std::uint32_t&)
+{
+	return 0;
+}
+
+#endif
+
+//	--------------------------------------------------------
+//	Definitions
+//	--------------------------------------------------------
+
+std::uint32_t OverlapMask(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count)
+{
+	return OverlapLanes<false, false>(r.left, r.left + r.width, r.top, r.top + r.height, rects, first, count);
+}
+
+std::uint32_t OverlapExtents(const Rect& r, const RectArrays& rects, std::size_t first, std::size_t count, int* across, int* down)
+{
+	std::uint32_t mask = 0;
+	std::size_t k = OverlapExtentLanes(r, rects, first, count, across, down, mask);
+
+	for (; k < count; k++)
+	{
+		std::size_t i = first + k;
+		across[k] = std::min(r.left + r.width, rects.left[i] + rects.width[i]) - std::max(r.left, rects.left[i]);
+		down[k] = std::min(r.top + r.height, rects.top[i] + rects.height[i]) - std::max(r.top, rects.top[i]);
+
+		if (across[k] > 0 && down[k] > 0)
+		{
+			mask |= 1u << k;
+		}
+	}
+
+	return mask;
+}
+
+std::uint32_t CrossingMask(const Rect& r, bool horizontal, const RectArrays& rects, std::size_t first, std::size_t count)
+{
+	if (horizontal)
+	{
+		return OverlapLanes<true, false>(r.left, r.left + r.width, r.top, r.top + r.height, rects, first, count);
+	}
+
+	return OverlapLanes<false, true>(r.left, r.left + r.width, r.top, r.top + r.height, rects, first, count);
+}
+
+inline int LowestBit(std::uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long bit;
+	_BitScanForward(&bit, mask);
+	return (int)bit;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+//	--------------------------------------------------------
+
+#endif
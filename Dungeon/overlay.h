@@ -0,0 +1,250 @@
+//	--------------------------------------------------------
+//	OVERLAY.H
+//	--------------------------------------------------------
+//	Debug drawing for the triangulation, the Voronoi diagram, the spanning tree and the rooms
+//	Each layer is one vertex array that's kept between frames and drawn in one call
+//	--------------------------------------------------------
+
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "dungeon.h"
+#include "linal.h"
+#include "topology.h"
+
+#include <cstdint>
+#include <unordered_set>
+
+#include <SFML/Graphics.hpp>
+
+//	--------------------------------------------------------
+//	Layers
+//	--------------------------------------------------------
+
+enum OverlayLayer
+{
+	DELAUNAY_LAYER,
+	VORONOI_LAYER,
+	MST_LAYER,
+	ROOM_LAYER,
+	LAYER_COUNT
+};
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+// Update checks the version on whatever it's handed and only refills the layers that are out of date, and only the visible ones
+// A layer that gets switched on catches up on the next Update
+// Vertex arrays rather than sf::VertexBuffer, so this still works on SFML older than 2.5
+class Overlay
+{
+private:
+	sf::VertexArray								layers_[LAYER_COUNT];
+	bool										visible_[LAYER_COUNT];
+
+	// Which source and which version of it each layer was filled from
+	const void*									sources_[LAYER_COUNT];
+	std::uint32_t								versions_[LAYER_COUNT];
+
+	// Whether to treat coordinates as tiles, the way the dungeon is laid out, or as pixels
+	bool										tiles_;
+
+	sf::Vector2f								Place(float x, float y) const;
+	bool										Stale(OverlayLayer layer, const void* source, std::uint32_t version) const;
+	void										Filled(OverlayLayer layer, const void* source, std::uint32_t version);
+
+	template <typename T> void					FillEdges(OverlayLayer layer, const BasicQuadEdgeMesh<T>& mesh, const EdgeList& edges, const sf::Color& color);
+	template <typename T> void					FillDual(OverlayLayer layer, const BasicQuadEdgeMesh<T>& mesh, const EdgeList& edges, const sf::Color& color);
+	void										FillRooms(const std::unordered_set<Rect>& rooms);
+
+public:
+	// The triangulation and the tree start out visible; the Voronoi diagram and the rooms don't
+	Overlay(bool tiles = false);
+
+	bool										visible(OverlayLayer layer) const				{ return visible_[layer]; };
+	void										setVisible(OverlayLayer layer, bool on)			{ visible_[layer] = on; };
+	void										Toggle(OverlayLayer layer)						{ visible_[layer] = !visible_[layer]; };
+
+	// How many vertices a layer holds right now, two per edge and four per room
+	std::size_t									vertexCount(OverlayLayer layer) const			{ return layers_[layer].getVertexCount(); };
+
+	// Refill whatever's stale; cheap to call every frame when nothing has moved
+	template <typename T> void					Update(BasicDelaunay<T>& del);
+	void										Update(Dungeon& dungeon);
+
+	// One draw call per visible layer, rooms first so the graphs sit on top of them
+	void										Draw(sf::RenderTarget& target, const sf::RenderStates& states = sf::RenderStates::Default) const;
+};
+
+//	--------------------------------------------------------
+//	Constructor
+//	--------------------------------------------------------
+
+Overlay::Overlay(bool tiles) : tiles_(tiles)
+{
+	for (int i = 0; i < LAYER_COUNT; i++)
+	{
+		layers_[i].setPrimitiveType(sf::Lines);
+		sources_[i] = NULL;
+		versions_[i] = 0;
+	}
+
+	layers_[ROOM_LAYER].setPrimitiveType(sf::Quads);
+
+	visible_[DELAUNAY_LAYER] = true;
+	visible_[VORONOI_LAYER] = false;
+	visible_[MST_LAYER] = true;
+	visible_[ROOM_LAYER] = false;
+}
+
+//	--------------------------------------------------------
+//	Helpers
+//	--------------------------------------------------------
+
+sf::Vector2f Overlay::Place(float x, float y) const
+{
+	return tiles_ ? FromTileCoords(x, y) : sf::Vector2f(x, y);
+}
+
+bool Overlay::Stale(OverlayLayer layer, const void* source, std::uint32_t version) const
+{
+	return visible_[layer] && (sources_[layer] != source || versions_[layer] != version);
+}
+
+void Overlay::Filled(OverlayLayer layer, const void* source, std::uint32_t version)
+{
+	sources_[layer] = source;
+	versions_[layer] = version;
+}
+
+template <typename T>
+void Overlay::FillEdges(OverlayLayer layer, const BasicQuadEdgeMesh<T>& mesh, const EdgeList& edges, const sf::Color& color)
+{
+	// Resizing keeps the memory from last time, so refilling a layer the same size doesn't allocate
+	sf::VertexArray& v = layers_[layer];
+	v.resize(edges.size() * 2);
+
+	for (std::size_t i = 0; i < edges.size(); i++)
+	{
+		const BasicVert<T>& org = mesh.origin(edges[i]);
+		const BasicVert<T>& dest = mesh.destination(edges[i]);
+
+		v[2 * i].position = Place(org.x(), org.y());
+		v[2 * i].color = color;
+		v[2 * i + 1].position = Place(dest.x(), dest.y());
+		v[2 * i + 1].color = color;
+	}
+}
+
+template <typename T>
+void Overlay::FillDual(OverlayLayer layer, const BasicQuadEdgeMesh<T>& mesh, const EdgeList& edges, const sf::Color& color)
+{
+	// Dual edges run between faces rather than Verts
+	sf::VertexArray& v = layers_[layer];
+	v.resize(edges.size() * 2);
+
+	for (std::size_t i = 0; i < edges.size(); i++)
+	{
+		const Vert& org = mesh.dualOrigin(edges[i]);
+		const Vert& dest = mesh.dualOrigin(Sym(edges[i]));
+
+		v[2 * i].position = Place(org.x(), org.y());
+		v[2 * i].color = color;
+		v[2 * i + 1].position = Place(dest.x(), dest.y());
+		v[2 * i + 1].color = color;
+	}
+}
+
+void Overlay::FillRooms(const std::unordered_set<Rect>& rooms)
+{
+	sf::VertexArray& v = layers_[ROOM_LAYER];
+	v.resize(rooms.size() * 4);
+
+	std::size_t i = 0;
+	for (auto r = rooms.begin(); r != rooms.end(); r++, i += 4)
+	{
+		sf::Color color = DungeonRNG::IsLarge(*r) ? sf::Color::White : sf::Color::Blue;
+
+		v[i].position = Place(r->left, r->top);
+		v[i + 1].position = Place(r->left + r->width, r->top);
+		v[i + 2].position = Place(r->left + r->width, r->top + r->height);
+		v[i + 3].position = Place(r->left, r->top + r->height);
+
+		for (std::size_t k = i; k < i + 4; k++)
+		{
+			v[k].color = color;
+		}
+	}
+}
+
+//	--------------------------------------------------------
+//	Keeping up
+//	--------------------------------------------------------
+
+template <typename T>
+void Overlay::Update(BasicDelaunay<T>& del)
+{
+	std::uint32_t version = del.version();
+
+	if (!Stale(DELAUNAY_LAYER, &del, version) && !Stale(VORONOI_LAYER, &del, version) && !Stale(MST_LAYER, &del, version))
+	{
+		return;
+	}
+
+	// A build that was still pending bumps the version again, so read it after
+	EdgeList edges = del.GetTriangulation();
+	version = del.version();
+
+	if (Stale(DELAUNAY_LAYER, &del, version))
+	{
+		FillEdges(DELAUNAY_LAYER, del.mesh(), edges, sf::Color::White);
+		Filled(DELAUNAY_LAYER, &del, version);
+	}
+
+	if (Stale(VORONOI_LAYER, &del, version))
+	{
+		FillDual(VORONOI_LAYER, del.mesh(), del.GetVoronoi(), sf::Color::Green);
+		Filled(VORONOI_LAYER, &del, version);
+	}
+
+	if (Stale(MST_LAYER, &del, version))
+	{
+		FillEdges(MST_LAYER, del.mesh(), del.GetMST(), sf::Color::Red);
+		Filled(MST_LAYER, &del, version);
+	}
+}
+
+void Overlay::Update(Dungeon& dungeon)
+{
+	if (Stale(ROOM_LAYER, &dungeon, dungeon.version()))
+	{
+		FillRooms(dungeon.rooms());
+		Filled(ROOM_LAYER, &dungeon, dungeon.version());
+	}
+}
+
+//	--------------------------------------------------------
+//	Drawing
+//	--------------------------------------------------------
+
+void Overlay::Draw(sf::RenderTarget& target, const sf::RenderStates& states) const
+{
+	const OverlayLayer order[LAYER_COUNT] = { ROOM_LAYER, VORONOI_LAYER, DELAUNAY_LAYER, MST_LAYER };
+
+	for (int i = 0; i < LAYER_COUNT; i++)
+	{
+		if (visible_[order[i]] && layers_[order[i]].getVertexCount() > 0)
+		{
+			target.draw(layers_[order[i]], states);
+		}
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
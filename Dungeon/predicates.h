@@ -0,0 +1,665 @@
+//	--------------------------------------------------------
+//	PREDICATES.H
+//	--------------------------------------------------------
+//	Contains robust orientation and in-circle tests
+//	A cheap floating-point filter answers almost every query; exact expansion arithmetic answers the rest
+//	Taken from Shewchuk, "Adaptive Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates" (1997)
+//	Integer coordinates skip all of that and get an exact 64/128-bit evaluation instead
+//	--------------------------------------------------------
+
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "stats.h"
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// For keeping rarely-taken paths out of the hot code that calls them
+#if defined(_MSC_VER)
+#define PREDICATES_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#define PREDICATES_NOINLINE __attribute__((noinline))
+#else
+#define PREDICATES_NOINLINE
+#endif
+
+//	--------------------------------------------------------
+//	Error bounds
+//	--------------------------------------------------------
+
+// Half an ulp of 1.0, and the constant we split doubles with
+// These are exact for IEEE doubles so we don't bother computing them at startup
+const double EPSILON							= 1.1102230246251565e-16;		// 2^-53
+const double SPLITTER							= 134217729.0;					// 2^27 + 1
+
+// If a determinant is bigger than its bound times the permanent, the sign we computed is right
+const double CCW_ERRBOUND						= (3.0 + 16.0 * EPSILON) * EPSILON;
+const double INCIRCLE_ERRBOUND					= (10.0 + 96.0 * EPSILON) * EPSILON;
+
+//	--------------------------------------------------------
+//	Exact arithmetic building blocks
+//	--------------------------------------------------------
+
+// An expansion is a sum of doubles with nonoverlapping bits, smallest magnitude first
+// Its sign is the sign of its last (biggest) component
+typedef std::vector<double>						Expansion;
+
+// x + y == a + b exactly
+inline void TwoSum(double a, double b, double& x, double& y)
+{
+	x = a + b;
+	double bvirt = x - a;
+	double avirt = x - bvirt;
+	double bround = b - bvirt;
+	double around = a - avirt;
+	y = around + bround;
+}
+
+// x + y == a - b exactly
+inline void TwoDiff(double a, double b, double& x, double& y)
+{
+	x = a - b;
+	double bvirt = a - x;
+	double avirt = x + bvirt;
+	double bround = bvirt - b;
+	double around = a - avirt;
+	y = around + bround;
+}
+
+// Cuts a double into two halves that each fit in 26 bits
+inline void Split(double a, double& hi, double& lo)
+{
+	double c = SPLITTER * a;
+	double abig = c - a;
+	hi = c - abig;
+	lo = a - hi;
+}
+
+// x + y == a * b exactly
+inline void TwoProduct(double a, double b, double& x, double& y)
+{
+	x = a * b;
+
+	double ahi, alo, bhi, blo;
+	Split(a, ahi, alo);
+	Split(b, bhi, blo);
+
+	double err1 = x - (ahi * bhi);
+	double err2 = err1 - (alo * bhi);
+	double err3 = err2 - (ahi * blo);
+	y = (alo * blo) - err3;
+}
+
+// h = e + f, dropping zeroes as we go
+Expansion ExpansionSum(const Expansion& e, const Expansion& f)
+{
+	Expansion h;
+	h.reserve(e.size() + f.size());
+
+	// Merge the components by magnitude, then run one pass of TwoSum over the merged list
+	std::size_t i = 0;
+	std::size_t j = 0;
+	double q;
+	double next;
+
+	if (e.empty())
+	{
+		return f;
+	}
+	if (f.empty())
+	{
+		return e;
+	}
+
+	if ((f[0] > e[0]) == (f[0] > -e[0]))
+	{
+		q = e[i++];
+	}
+	else
+	{
+		q = f[j++];
+	}
+
+	while (i < e.size() || j < f.size())
+	{
+		if (j == f.size() || (i < e.size() && (f[j] > e[i]) == (f[j] > -e[i])))
+		{
+			next = e[i++];
+		}
+		else
+		{
+			next = f[j++];
+		}
+
+		double sum, err;
+		TwoSum(q, next, sum, err);
+		if (err != 0.0)
+		{
+			h.push_back(err);
+		}
+		q = sum;
+	}
+
+	if (q != 0.0 || h.empty())
+	{
+		h.push_back(q);
+	}
+
+	return h;
+}
+
+// h = e * b, dropping zeroes as we go
+Expansion ScaleExpansion(const Expansion& e, double b)
+{
+	Expansion h;
+	h.reserve(e.size() * 2);
+
+	if (e.empty())
+	{
+		return h;
+	}
+
+	double q, hh;
+	TwoProduct(e[0], b, q, hh);
+	if (hh != 0.0)
+	{
+		h.push_back(hh);
+	}
+
+	for (std::size_t i = 1; i < e.size(); i++)
+	{
+		double p1, p0, sum;
+		TwoProduct(e[i], b, p1, p0);
+		TwoSum(q, p0, sum, hh);
+		if (hh != 0.0)
+		{
+			h.push_back(hh);
+		}
+		TwoSum(p1, sum, q, hh);
+		if (hh != 0.0)
+		{
+			h.push_back(hh);
+		}
+	}
+
+	if (q != 0.0 || h.empty())
+	{
+		h.push_back(q);
+	}
+
+	return h;
+}
+
+// h = e * f, which is just a sum of scaled copies of e
+Expansion ExpansionProduct(const Expansion& e, const Expansion& f)
+{
+	Expansion h;
+
+	for (std::size_t i = 0; i < f.size(); i++)
+	{
+		h = ExpansionSum(h, ScaleExpansion(e, f[i]));
+	}
+
+	return h;
+}
+
+Expansion ExpansionDiff(const Expansion& e, const Expansion& f)
+{
+	Expansion g(f);
+
+	for (std::size_t i = 0; i < g.size(); i++)
+	{
+		g[i] = -g[i];
+	}
+
+	return ExpansionSum(e, g);
+}
+
+// The exact difference of two doubles, as a two-term expansion
+Expansion ExactDiff(double a, double b)
+{
+	double x, y;
+	TwoDiff(a, b, x, y);
+
+	Expansion h;
+	if (y != 0.0)
+	{
+		h.push_back(y);
+	}
+	h.push_back(x);
+	return h;
+}
+
+double ExpansionSign(const Expansion& e)
+{
+	return e.empty() ? 0.0 : e.back();
+}
+
+//	--------------------------------------------------------
+//	Exact integer arithmetic
+//	--------------------------------------------------------
+
+// The integer predicates want coordinates inside +/- 2^29 so that:
+// differences fit in 31 bits, lifted coordinates and 2x2 minors fit in 63, and the in-circle sum fits in 125
+// OrientSign and InCircleSign check, and send anything bigger down the floating-point path instead
+const std::int64_t EXACT_COORD_LIMIT			= (std::int64_t)1 << 29;
+
+#if defined(__SIZEOF_INT128__)
+
+// The compiler has a native 128-bit integer, so just use it
+typedef __int128								Int128;
+
+inline Int128 WideMultiply(std::int64_t a, std::int64_t b)		{ return (Int128)a * (Int128)b; };
+inline int WideSign(Int128 a)									{ return (a > 0) - (a < 0); };
+
+#else
+
+// MSVC has no 128-bit integer, so here's just enough of one to add up products of 64-bit numbers
+struct Int128
+{
+	std::uint64_t lo;
+	std::uint64_t hi;
+
+	Int128() : lo(0), hi(0) {};
+	Int128(std::uint64_t _lo, std::uint64_t _hi) : lo(_lo), hi(_hi) {};
+
+	Int128 operator+(const Int128& o) const
+	{
+		std::uint64_t sum = lo + o.lo;
+		return Int128(sum, hi + o.hi + (sum < lo ? 1 : 0));
+	};
+
+	Int128 operator-() const
+	{
+		// Two's complement, carried across the halves
+		std::uint64_t nlo = ~lo + 1;
+		return Int128(nlo, ~hi + (nlo == 0 ? 1 : 0));
+	};
+
+	Int128 operator-(const Int128& o) const						{ return *this + (-o); };
+};
+
+inline Int128 WideMultiply(std::int64_t a, std::int64_t b)
+{
+	// Multiply the magnitudes 32 bits at a time, then fix the sign
+	bool negative = (a < 0) != (b < 0);
+	std::uint64_t ua = (a < 0) ? (std::uint64_t)(-a) : (std::uint64_t)a;
+	std::uint64_t ub = (b < 0) ? (std::uint64_t)(-b) : (std::uint64_t)b;
+
+	std::uint64_t a_lo = ua & 0xffffffff;
+	std::uint64_t a_hi = ua >> 32;
+	std::uint64_t b_lo = ub & 0xffffffff;
+	std::uint64_t b_hi = ub >> 32;
+
+	std::uint64_t ll = a_lo * b_lo;
+	std::uint64_t lh = a_lo * b_hi;
+	std::uint64_t hl = a_hi * b_lo;
+	std::uint64_t hh = a_hi * b_hi;
+
+	std::uint64_t mid = (ll >> 32) + (lh & 0xffffffff) + (hl & 0xffffffff);
+	Int128 product((ll & 0xffffffff) | (mid << 32), hh + (lh >> 32) + (hl >> 32) + (mid >> 32));
+
+	return negative ? -product : product;
+}
+
+inline int WideSign(const Int128& a)
+{
+	if (a.hi >> 63)
+	{
+		return -1;
+	}
+	return (a.hi != 0 || a.lo != 0) ? 1 : 0;
+}
+
+#endif
+
+// Both of these are exact as long as the inputs respect EXACT_COORD_LIMIT
+// No filter and no fallback, so they come out the same on every machine
+
+inline int Orient2DInt(std::int64_t ax, std::int64_t ay, std::int64_t bx, std::int64_t by, std::int64_t cx, std::int64_t cy)
+{
+	std::int64_t det = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+	return (det > 0) - (det < 0);
+}
+
+inline int InCircle2DInt(std::int64_t ax, std::int64_t ay, std::int64_t bx, std::int64_t by, std::int64_t cx, std::int64_t cy, std::int64_t dx, std::int64_t dy)
+{
+	std::int64_t adx = ax - dx;
+	std::int64_t ady = ay - dy;
+	std::int64_t bdx = bx - dx;
+	std::int64_t bdy = by - dy;
+	std::int64_t cdx = cx - dx;
+	std::int64_t cdy = cy - dy;
+
+	std::int64_t alift = adx * adx + ady * ady;
+	std::int64_t blift = bdx * bdx + bdy * bdy;
+	std::int64_t clift = cdx * cdx + cdy * cdy;
+
+	Int128 det = WideMultiply(alift, bdx * cdy - cdx * bdy)
+			   + WideMultiply(blift, cdx * ady - adx * cdy)
+			   + WideMultiply(clift, adx * bdy - bdx * ady);
+
+	return WideSign(det);
+}
+
+//	--------------------------------------------------------
+//	Exact fallbacks
+//	--------------------------------------------------------
+
+// These only run when the filter can't decide, so they don't have to be clever, just right
+// Both work on exact coordinate differences so nothing rounds before the products
+
+// Points on the tile grid are where the filter gives up most, and their differences are small whole numbers
+// Those go through the integer predicates instead, which are exact without building a single expansion
+inline bool IntegerDiff(double a, double b, std::int64_t& diff)
+{
+	double x, y;
+	TwoDiff(a, b, x, y);
+
+	if (y != 0.0 || !(std::fabs(x) < EXACT_COORD_LIMIT) || x != std::floor(x))
+	{
+		return false;
+	}
+
+	diff = (std::int64_t)x;
+	return true;
+}
+
+double Orient2DExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	std::int64_t iacx, iacy, ibcx, ibcy;
+	if (IntegerDiff(ax, cx, iacx) && IntegerDiff(ay, cy, iacy) && IntegerDiff(bx, cx, ibcx) && IntegerDiff(by, cy, ibcy))
+	{
+		return Orient2DInt(iacx, iacy, ibcx, ibcy, 0, 0);
+	}
+
+	Expansion acx = ExactDiff(ax, cx);
+	Expansion bcx = ExactDiff(bx, cx);
+	Expansion acy = ExactDiff(ay, cy);
+	Expansion bcy = ExactDiff(by, cy);
+
+	Expansion det = ExpansionDiff(ExpansionProduct(acx, bcy), ExpansionProduct(acy, bcx));
+	return ExpansionSign(det);
+}
+
+double InCircleExact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	std::int64_t iadx, iady, ibdx, ibdy, icdx, icdy;
+	if (IntegerDiff(ax, dx, iadx) && IntegerDiff(ay, dy, iady) && IntegerDiff(bx, dx, ibdx) && IntegerDiff(by, dy, ibdy) && IntegerDiff(cx, dx, icdx) && IntegerDiff(cy, dy, icdy))
+	{
+		return InCircle2DInt(iadx, iady, ibdx, ibdy, icdx, icdy, 0, 0);
+	}
+
+	Expansion adx = ExactDiff(ax, dx);
+	Expansion ady = ExactDiff(ay, dy);
+	Expansion bdx = ExactDiff(bx, dx);
+	Expansion bdy = ExactDiff(by, dy);
+	Expansion cdx = ExactDiff(cx, dx);
+	Expansion cdy = ExactDiff(cy, dy);
+
+	// Lift each point onto the paraboloid, relative to d
+	Expansion alift = ExpansionSum(ExpansionProduct(adx, adx), ExpansionProduct(ady, ady));
+	Expansion blift = ExpansionSum(ExpansionProduct(bdx, bdx), ExpansionProduct(bdy, bdy));
+	Expansion clift = ExpansionSum(ExpansionProduct(cdx, cdx), ExpansionProduct(cdy, cdy));
+
+	// The 2x2 minors that go with each lifted coordinate
+	Expansion bc = ExpansionDiff(ExpansionProduct(bdx, cdy), ExpansionProduct(cdx, bdy));
+	Expansion ca = ExpansionDiff(ExpansionProduct(cdx, ady), ExpansionProduct(adx, cdy));
+	Expansion ab = ExpansionDiff(ExpansionProduct(adx, bdy), ExpansionProduct(bdx, ady));
+
+	Expansion det = ExpansionSum(ExpansionSum(ExpansionProduct(alift, bc), ExpansionProduct(blift, ca)), ExpansionProduct(clift, ab));
+	return ExpansionSign(det);
+}
+
+//	--------------------------------------------------------
+//	The predicates themselves
+//	--------------------------------------------------------
+
+// Positive if a, b, c wind counterclockwise, negative if clockwise, zero if collinear
+double Orient2D(double ax, double ay, double bx, double by, double cx, double cy)
+{
+	double detleft = (ax - cx) * (by - cy);
+	double detright = (ay - cy) * (bx - cx);
+	double det = detleft - detright;
+
+	// If the two products have opposite signs (or one is zero) there's no cancellation to worry about
+	double detsum;
+	if (detleft > 0.0)
+	{
+		if (detright <= 0.0)
+		{
+			return det;
+		}
+		detsum = detleft + detright;
+	}
+	else if (detleft < 0.0)
+	{
+		if (detright >= 0.0)
+		{
+			return det;
+		}
+		detsum = -detleft - detright;
+	}
+	else
+	{
+		return det;
+	}
+
+	double errbound = CCW_ERRBOUND * detsum;
+	if (det >= errbound || -det >= errbound)
+	{
+		return det;
+	}
+
+	DELAUNAY_COUNT(orientExact);
+	return Orient2DExact(ax, ay, bx, by, cx, cy);
+}
+
+// Positive if d is inside the circle through a, b, c (taken counterclockwise), negative if outside, zero if on it
+// This is the 4x4 lifted determinant with the row of ones eliminated by translating d to the origin
+double InCircle2D(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	double adx = ax - dx;
+	double bdx = bx - dx;
+	double cdx = cx - dx;
+	double ady = ay - dy;
+	double bdy = by - dy;
+	double cdy = cy - dy;
+
+	double bdxcdy = bdx * cdy;
+	double cdxbdy = cdx * bdy;
+	double alift = adx * adx + ady * ady;
+
+	double cdxady = cdx * ady;
+	double adxcdy = adx * cdy;
+	double blift = bdx * bdx + bdy * bdy;
+
+	double adxbdy = adx * bdy;
+	double bdxady = bdx * ady;
+	double clift = cdx * cdx + cdy * cdy;
+
+	double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+
+	// Same determinant with every term made positive; the rounding error can't be bigger than a sliver of this
+	double permanent = (std::fabs(bdxcdy) + std::fabs(cdxbdy)) * alift
+					 + (std::fabs(cdxady) + std::fabs(adxcdy)) * blift
+					 + (std::fabs(adxbdy) + std::fabs(bdxady)) * clift;
+
+	double errbound = INCIRCLE_ERRBOUND * permanent;
+	if (det > errbound || -det > errbound)
+	{
+		return det;
+	}
+
+	// Every term vanished, which is what a repeated point looks like (the merge asks about those a lot)
+	// Coordinates that started out as floats or ints can't underflow a double product, so that zero is real
+	if (permanent == 0.0)
+	{
+		return 0.0;
+	}
+
+	DELAUNAY_COUNT(inCircleExact);
+	return InCircleExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//	--------------------------------------------------------
+//	Picking a path by coordinate type
+//	--------------------------------------------------------
+
+// Integer coordinates take the exact path; anything else goes through the filter
+// The choice is made at compile time, so neither path pays for the other
+// Integers past EXACT_COORD_LIMIT would overflow the integer sums, so those go through the filter too:
+// every int is exactly a double, and the filter falls back to exact arithmetic, so the sign is still exact, just slower
+
+template <typename T> int OrientSign(T ax, T ay, T bx, T by, T cx, T cy, std::false_type)
+{
+	double det = Orient2D(ax, ay, bx, by, cx, cy);
+	return (det > 0) - (det < 0);
+}
+
+template <typename T> int InCircleSign(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy, std::false_type)
+{
+	double det = InCircle2D(ax, ay, bx, by, cx, cy, dx, dy);
+	return (det > 0) - (det < 0);
+}
+
+// Shifted up by the limit, everything in range is under twice the limit, which is a power of two,
+// so OR-ing a handful of these together and comparing once checks them all
+template <typename T> inline std::uint64_t ExactRangeBits(T v)
+{
+	return (std::uint64_t)((std::int64_t)v + EXACT_COORD_LIMIT);
+}
+
+const std::uint64_t EXACT_RANGE_BITS			= 2 * (std::uint64_t)EXACT_COORD_LIMIT;
+
+// Big integers are rare, so their detour is kept out of line, where it doesn't bloat every caller
+template <typename T> PREDICATES_NOINLINE int OrientSignWide(T ax, T ay, T bx, T by, T cx, T cy)
+{
+	return OrientSign(ax, ay, bx, by, cx, cy, std::false_type());
+}
+
+template <typename T> PREDICATES_NOINLINE int InCircleSignWide(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+{
+	return InCircleSign(ax, ay, bx, by, cx, cy, dx, dy, std::false_type());
+}
+
+template <typename T> int OrientSign(T ax, T ay, T bx, T by, T cx, T cy, std::true_type)
+{
+	if ((ExactRangeBits(ax) | ExactRangeBits(ay) | ExactRangeBits(bx) | ExactRangeBits(by) | ExactRangeBits(cx) | ExactRangeBits(cy)) < EXACT_RANGE_BITS)
+	{
+		return Orient2DInt(ax, ay, bx, by, cx, cy);
+	}
+
+	return OrientSignWide(ax, ay, bx, by, cx, cy);
+}
+
+template <typename T> int InCircleSign(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy, std::true_type)
+{
+	if ((ExactRangeBits(ax) | ExactRangeBits(ay) | ExactRangeBits(bx) | ExactRangeBits(by) |
+		ExactRangeBits(cx) | ExactRangeBits(cy) | ExactRangeBits(dx) | ExactRangeBits(dy)) < EXACT_RANGE_BITS)
+	{
+		return InCircle2DInt(ax, ay, bx, by, cx, cy, dx, dy);
+	}
+
+	return InCircleSignWide(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//	--------------------------------------------------------
+//	Breaking ties
+//	--------------------------------------------------------
+
+// Four points on one circle (any square of rooms on the tile grid) can be triangulated either way
+// Left alone, which way we go depends on how the points happened to be split, so two builds of the same points can disagree
+// Instead we pretend every point sits a hair above the paraboloid we lift onto, the lexicographically biggest one the most,
+// each hair infinitely bigger than the next (simulation of simplicity; Edelsbrunner and Mucke)
+// The determinant is linear in the lifted column, so the first point down that order with a nonzero cofactor settles it
+// That cofactor is just the orientation of the other three, and x and y never move, so no orientation ever changes
+
+template <typename T> bool LexGreater(T ax, T ay, T bx, T by)
+{
+	return (ax > bx) || (ax == bx && ay > by);
+}
+
+template <typename T> int InCircleTieBreak(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+{
+	const T x[4] = { ax, bx, cx, dx };
+	const T y[4] = { ay, by, cy, dy };
+
+	// Biggest first; it's four things, so insertion sort
+	int order[4] = { 0, 1, 2, 3 };
+	for (int i = 1; i < 4; i++)
+	{
+		for (int j = i; j > 0 && LexGreater(x[order[j]], y[order[j]], x[order[j - 1]], y[order[j - 1]]); j--)
+		{
+			std::swap(order[j], order[j - 1]);
+		}
+	}
+
+	// A repeated point gets the same nudge twice and the two cancel, so there's no tie to break
+	for (int i = 1; i < 4; i++)
+	{
+		if (x[order[i]] == x[order[i - 1]] && y[order[i]] == y[order[i - 1]])
+		{
+			return 0;
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		// The other three, in their original order; a and c come in with a plus sign, b and d with a minus
+		int p = order[i];
+		int o[3];
+		for (int j = 0, k = 0; j < 4; j++)
+		{
+			if (j != p)
+			{
+				o[k++] = j;
+			}
+		}
+
+		int sign = OrientSign(x[o[0]], y[o[0]], x[o[1]], y[o[1]], x[o[2]], y[o[2]], typename std::is_integral<T>::type());
+		if (sign != 0)
+		{
+			return (p % 2 == 0) ? sign : -sign;
+		}
+	}
+
+	// All four on one line
+	return 0;
+}
+
+//	--------------------------------------------------------
+//	The entry points
+//	--------------------------------------------------------
+
+template <typename T> int OrientSign(T ax, T ay, T bx, T by, T cx, T cy)
+{
+	DELAUNAY_COUNT(orientCalls);
+	return OrientSign(ax, ay, bx, by, cx, cy, typename std::is_integral<T>::type());
+}
+
+template <typename T> int InCircleSign(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+{
+	DELAUNAY_COUNT(inCircleCalls);
+	int sign = InCircleSign(ax, ay, bx, by, cx, cy, dx, dy, typename std::is_integral<T>::type());
+
+	if (sign != 0)
+	{
+		return sign;
+	}
+
+	DELAUNAY_COUNT(inCircleTies);
+	return InCircleTieBreak(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//	--------------------------------------------------------
+
+#endif
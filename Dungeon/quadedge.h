@@ -15,57 +15,416 @@
 //	--------------------------------------------------------
 
 #include "edge.h"
-#include <memory>
+#include "stats.h"
+
+#include <cstdint>
+#include <vector>
+
+//	--------------------------------------------------------
+//	One directed edge's worth of data
+//	--------------------------------------------------------
+
+// Four of these in a row make a QuadEdge
+// Primal edges originate at a Vert; dual edges originate at a face (which is a Voronoi vertex once we have one)
+struct EdgeRecord
+{
+	EdgeRef												next;
+	std::uint32_t										origin;
+};
+
+//	--------------------------------------------------------
+//	Somewhere to get QuadEdges from
+//	--------------------------------------------------------
+
+// A free list plus a run of untouched records to bump through
+// The mesh has one of its own that grows the array; a parallel triangulation carves out a fixed run per task,
+// so each thread allocates from records nobody else can touch and never has to take a lock
+struct EdgeArena
+{
+	EdgeRef												free;
+	EdgeRef												freeTail;
+	EdgeRef												next;
+	EdgeRef												end;									// NIL means grow the array when we run out
+	std::int32_t										live;									// QuadEdges made minus QuadEdges freed
+};
 
 //	--------------------------------------------------------
 //	The class
 //	--------------------------------------------------------
 
-class QuadEdge
+// Owns every Vert and QuadEdge of a subdivision in flat arrays
+// Killed QuadEdges go on a free list threaded through their 0th record, so allocating and freeing are both O(1)
+// Every allocation goes through an EdgeArena; the mesh's own one is used unless someone passes a different one
+// T is the coordinate type of the Verts; faces always get float coordinates since they're computed
+template <typename T>
+class BasicQuadEdgeMesh
 {
 public:
-	Edge edges[4];
-	QuadEdge();
+	typedef BasicVert<T>								VertType;
+
+private:
+	// Coordinates, plus one edge leaving each Vert so we can walk around it
+	std::vector<VertType>								verts_;
+	std::vector<EdgeRef>								vertEdges_;
+
+	// Coordinates of the faces, for when someone sets the origin of a dual edge
+	std::vector<Vert>									faces_;
+
+	// Four records per QuadEdge
+	std::vector<EdgeRecord>								edges_;
+
+	// Where MakeEdge gets QuadEdges from when nobody says otherwise
+	EdgeArena											arena_;
+
+public:
+	BasicQuadEdgeMesh();
+
+	// Forget everything but keep the memory
+	// ClearEdges only forgets the QuadEdges, so the same Verts can be triangulated again
+	void												Reset();
+	void												ClearEdges();
+	void												Reserve(std::uint32_t verts, std::uint32_t quads);
+
+	// Allocation
+	VertRef												AddVert(T x, T y);
+	std::uint32_t										AddFace(float x, float y);
+	EdgeRef												MakeEdge()								{ return MakeEdge(arena_); };
+	EdgeRef												MakeEdge(EdgeArena& arena);
+	void												FreeEdge(EdgeRef e)						{ FreeEdge(arena_, e); };
+	void												FreeEdge(EdgeArena& arena, EdgeRef e);
+
+	// Splitting and joining arenas for threads
+	// Presize makes sure there are enough dead records past the mesh's bump pointer that nothing reallocates
+	// Carve hands out a run of quads from a parent; Return gives back whatever the child didn't use, plus its free list
+	EdgeArena&											arena()									{ return arena_; };
+	const EdgeArena&									arena() const							{ return arena_; };
+	void												Presize(std::uint32_t quads);
+	EdgeArena											Carve(EdgeArena& parent, std::uint32_t quads);
+	void												Return(EdgeArena& parent, EdgeArena& child);
+
+	// An edge has four primitive algebraic operations; see Guibas and Stolfi
+	// Rot, InvRot and Sym live in edge.h because they don't need memory
+	EdgeRef												Onext(EdgeRef e) const					{ return edges_[e].next; };
+
+	// These guys can be derived from the four primitive operations
+	EdgeRef												Oprev(EdgeRef e) const					{ return Rot(Onext(Rot(e))); };
+	EdgeRef												Dnext(EdgeRef e) const					{ return Sym(Onext(Sym(e))); };
+	EdgeRef												Dprev(EdgeRef e) const					{ return InvRot(Onext(InvRot(e))); };
+	EdgeRef												Lnext(EdgeRef e) const					{ return Rot(Onext(InvRot(e))); };
+	EdgeRef												Lprev(EdgeRef e) const					{ return Sym(Onext(e)); };
+	EdgeRef												Rnext(EdgeRef e) const					{ return InvRot(Onext(Rot(e))); };
+	EdgeRef												Rprev(EdgeRef e) const					{ return Onext(Sym(e)); };
+
+	// Accessors and mutators
+	VertRef												Org(EdgeRef e) const					{ return edges_[e].origin; };
+	VertRef												Dest(EdgeRef e) const					{ return edges_[Sym(e)].origin; };
+	const VertType&										origin(EdgeRef e) const					{ return verts_[Org(e)]; };
+	const VertType&										destination(EdgeRef e) const			{ return verts_[Dest(e)]; };
+	const Vert&											dualOrigin(EdgeRef e) const				{ return faces_[edges_[e].origin]; };
+
+	// The faces either side of a primal edge, which are the origins of its duals; NIL if nobody's set them
+	std::uint32_t										Left(EdgeRef e) const					{ return edges_[InvRot(e)].origin; };
+	std::uint32_t										Right(EdgeRef e) const					{ return edges_[Rot(e)].origin; };
+
+	void												setNext(EdgeRef e, EdgeRef next)		{ edges_[e].next = next; };
+	void												setOrigin(EdgeRef e, VertRef v);
+	void												setDestination(EdgeRef e, VertRef v)	{ setOrigin(Sym(e), v); };
+	void												setDualOrigin(EdgeRef e, std::uint32_t f){ edges_[e].origin = f; };
+
+	// Per-Vert accessors
+	const VertType&										vert(VertRef v) const					{ return verts_[v]; };
+	void												setVert(VertRef v, T x, T y)			{ verts_[v] = VertType(x, y); };
+	EdgeRef												edge(VertRef v) const					{ return vertEdges_[v]; };
+	std::uint32_t										vertCount() const						{ return verts_.size(); };
+	const std::vector<VertType>&						verts() const							{ return verts_; };
+
+	// Per-face accessors; ClearFaces forgets them all so they can be computed again without piling up
+	const Vert&											face(std::uint32_t f) const				{ return faces_[f]; };
+	std::uint32_t										faceCount() const						{ return faces_.size(); };
+	void												ClearFaces(std::uint32_t reserve)		{ faces_.clear(); faces_.reserve(reserve); };
+
+	// The raw arrays, for writing the whole thing out in one go
+	const std::vector<EdgeRef>&							vertEdges() const						{ return vertEdges_; };
+	const std::vector<Vert>&							faces() const							{ return faces_; };
+	const std::vector<EdgeRecord>&						records() const							{ return edges_; };
+
+	// Per-QuadEdge accessors; a QuadEdge is dead if it's sitting on the free list
+	std::uint32_t										quadCapacity() const					{ return edges_.size() / 4; };
+	std::uint32_t										quadCount() const						{ return arena_.live; };
+	bool												IsLive(std::uint32_t quad) const		{ return edges_[quad * 4].origin != NIL; };
+
+	// The one operation that changes topology, and the one that cuts an edge out and frees it
+	// Swap turns an edge between two triangles into the other diagonal of their quadrilateral
+	void												Splice(EdgeRef a, EdgeRef b);
+	void												Swap(EdgeRef e);
+	void												DeleteEdge(EdgeRef e)					{ DeleteEdge(arena_, e); };
+	void												DeleteEdge(EdgeArena& arena, EdgeRef e);
 };
 
+typedef BasicQuadEdgeMesh<float>						QuadEdgeMesh;
+typedef BasicQuadEdgeMesh<int>							IntQuadEdgeMesh;
+
 //	--------------------------------------------------------
 //	Constructor
 //	--------------------------------------------------------
 
-QuadEdge::QuadEdge()
+template <typename T>
+BasicQuadEdgeMesh<T>::BasicQuadEdgeMesh()
+{
+	Reset();
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::Reset()
 {
-	// Make sure the edges know their own indices for memory magic
-	edges[0].setIndex(0);
-	edges[1].setIndex(1);
-	edges[2].setIndex(2);
-	edges[3].setIndex(3);
+	// clear() leaves the capacity alone, so the next generation doesn't go back to the allocator
+	verts_.clear();
+	vertEdges_.clear();
+	faces_.clear();
+	edges_.clear();
 
-	// By default, don't render them
-	edges[0].draw = false;
-	edges[1].draw = false;
-	edges[2].draw = false;
-	edges[3].draw = false;
+	EdgeArena fresh = { NIL, NIL, 0, NIL, 0 };
+	arena_ = fresh;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::ClearEdges()
+{
+	edges_.clear();
+	faces_.clear();
+
+	for (std::size_t v = 0; v < vertEdges_.size(); v++)
+	{
+		vertEdges_[v] = NIL;
+	}
+
+	EdgeArena fresh = { NIL, NIL, 0, NIL, 0 };
+	arena_ = fresh;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::Reserve(std::uint32_t verts, std::uint32_t quads)
+{
+	verts_.reserve(verts);
+	vertEdges_.reserve(verts);
+	edges_.reserve(quads * 4);
+}
+
+//	--------------------------------------------------------
+//	Allocation
+//	--------------------------------------------------------
+
+template <typename T>
+VertRef BasicQuadEdgeMesh<T>::AddVert(T x, T y)
+{
+	verts_.push_back(VertType(x, y));
+	vertEdges_.push_back(NIL);
+	return verts_.size() - 1;
+}
+
+template <typename T>
+std::uint32_t BasicQuadEdgeMesh<T>::AddFace(float x, float y)
+{
+	faces_.push_back(Vert(x, y));
+	return faces_.size() - 1;
+}
+
+template <typename T>
+EdgeRef BasicQuadEdgeMesh<T>::MakeEdge(EdgeArena& arena)
+{
+	DELAUNAY_COUNT(edgesMade);
+	EdgeRef e;
+
+	if (arena.free != NIL)
+	{
+		// Reuse something we killed earlier
+		e = arena.free;
+		arena.free = edges_[e].next;
+	}
+	else
+	{
+		// Otherwise take the next four fresh records, tacking them onto the end if we have to
+		e = arena.next;
+		arena.next += 4;
+
+		if (arena.end == NIL && arena.next > edges_.size())
+		{
+			edges_.resize(arena.next);
+		}
+	}
 
 	// Set them up to point to each other
-	edges[0].setNext((edges + 0));
-	edges[1].setNext((edges + 3));
-	edges[2].setNext((edges + 2));
-	edges[3].setNext((edges + 1));
+	edges_[e + 0].next = e + 0;
+	edges_[e + 1].next = e + 3;
+	edges_[e + 2].next = e + 2;
+	edges_[e + 3].next = e + 1;
+
+	// Nobody has an origin yet; the caller fills those in
+	// The 0th one gets a placeholder so IsLive doesn't think we're on the free list
+	edges_[e + 0].origin = 0;
+	edges_[e + 1].origin = NIL;
+	edges_[e + 2].origin = NIL;
+	edges_[e + 3].origin = NIL;
+
+	arena.live++;
+
+	return e;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::FreeEdge(EdgeArena& arena, EdgeRef e)
+{
+	// Thread the QuadEdge onto the free list through its 0th record
+	e = Canonical(e);
+	edges_[e].origin = NIL;
+	edges_[e].next = arena.free;
+
+	if (arena.free == NIL)
+	{
+		arena.freeTail = e;
+	}
+
+	arena.free = e;
+	arena.live--;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::Presize(std::uint32_t quads)
+{
+	// Dead records, so IsLive skips whatever a task ends up not using
+	EdgeRecord dead = { NIL, NIL };
+
+	if (edges_.size() < arena_.next + quads * 4)
+	{
+		edges_.resize(arena_.next + quads * 4, dead);
+	}
+}
+
+template <typename T>
+EdgeArena BasicQuadEdgeMesh<T>::Carve(EdgeArena& parent, std::uint32_t quads)
+{
+	// The child gets a run of records all to itself and starts with an empty free list
+	EdgeArena child = { NIL, NIL, parent.next, parent.next + quads * 4, 0 };
+	parent.next = child.end;
+	return child;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::Return(EdgeArena& parent, EdgeArena& child)
+{
+	// Anything left in the child's run goes on its free list, since the parent's bump pointer is already past it
+	while (child.next < child.end)
+	{
+		FreeEdge(child, child.next);
+		child.next += 4;
+		child.live++;
+	}
+
+	// Then splice the child's free list onto the front of the parent's
+	if (child.free != NIL)
+	{
+		edges_[child.freeTail].next = parent.free;
+
+		if (parent.free == NIL)
+		{
+			parent.freeTail = child.freeTail;
+		}
+
+		parent.free = child.free;
+	}
+
+	parent.live += child.live;
+
+	EdgeArena empty = { NIL, NIL, child.end, child.end, 0 };
+	child = empty;
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::setOrigin(EdgeRef e, VertRef v)
+{
+	edges_[e].origin = v;
+	vertEdges_[v] = e;
 }
 
 //	--------------------------------------------------------
-//	This function depends on the definition of QuadEdge, so has to sit here
+//	Uh, this guy
 //	--------------------------------------------------------
 
-Edge* Edge::Make(std::vector<QuadEdge*>& list)
+template <typename T>
+void BasicQuadEdgeMesh<T>::Splice(EdgeRef a, EdgeRef b)
+{
+	// This remains unintelligible to me
+	// See Guibas and Stolfi, also Heckbert's code
+	DELAUNAY_COUNT(splices);
+
+	EdgeRef alpha = Rot(Onext(a));
+	EdgeRef beta = Rot(Onext(b));
+
+	EdgeRef t1 = Onext(b);
+	EdgeRef t2 = Onext(a);
+	EdgeRef t3 = Onext(beta);
+	EdgeRef t4 = Onext(alpha);
+
+	setNext(a, t1);
+	setNext(b, t2);
+	setNext(alpha, t3);
+	setNext(beta, t4);
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::Swap(EdgeRef e)
+{
+	// See Guibas and Stolfi; the edge gets cut loose and spliced back in across the other two corners
+	EdgeRef sym = Sym(e);
+	EdgeRef a = Oprev(e);
+	EdgeRef b = Oprev(sym);
+
+	// The old endpoints are about to lose this edge, so point them at something that stays
+	if (vertEdges_[Org(e)] == e)
+	{
+		vertEdges_[Org(e)] = a;
+	}
+	if (vertEdges_[Org(sym)] == sym)
+	{
+		vertEdges_[Org(sym)] = b;
+	}
+
+	Splice(e, a);
+	Splice(sym, b);
+	Splice(e, Lnext(a));
+	Splice(sym, Lnext(b));
+
+	setOrigin(e, Dest(a));
+	setDestination(e, Dest(b));
+}
+
+template <typename T>
+void BasicQuadEdgeMesh<T>::DeleteEdge(EdgeArena& arena, EdgeRef e)
 {
-	// To create a new Edge, make sure to call this function
-	// Create a QuadEdge to hold our new Edge and make aure we keep trck of it
-	list.push_back(new QuadEdge());
-	// Return the index of the 0th edge
-	return list.back()->edges;
+	DELAUNAY_COUNT(kills);
+	EdgeRef sym = Sym(e);
+	VertRef org = Org(e);
+	VertRef dest = Org(sym);
+	EdgeRef oprev = Oprev(e);
+	EdgeRef sym_oprev = Oprev(sym);
+
+	// Fix the local mesh
+	Splice(e, oprev);
+	Splice(sym, sym_oprev);
+
+	// Don't let the endpoints keep pointing at a dead edge
+	if (vertEdges_[org] == e)
+	{
+		vertEdges_[org] = (oprev != e) ? oprev : NIL;
+	}
+	if (vertEdges_[dest] == sym)
+	{
+		vertEdges_[dest] = (sym_oprev != sym) ? sym_oprev : NIL;
+	}
+
+	FreeEdge(arena, e);
 }
 
 //	--------------------------------------------------------
 
-#endif
\ No newline at end of file
+#endif
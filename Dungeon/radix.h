@@ -0,0 +1,156 @@
+//	--------------------------------------------------------
+//	RADIX.H
+//	--------------------------------------------------------
+//	Contains a linear-time sort on 64-bit keys, plus the bit tricks for turning coordinates into keys
+//	--------------------------------------------------------
+
+#ifndef RADIX_H
+#define RADIX_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//	--------------------------------------------------------
+//	Keys
+//	--------------------------------------------------------
+
+// Something to sort, and where it came from
+struct RadixItem
+{
+	std::uint64_t										key;
+	std::uint32_t										index;
+};
+
+// Unsigned bits that sort the same way the number does
+// Floats flip every bit when they're negative and just the sign bit otherwise; -0 gets folded into +0 first
+inline std::uint32_t OrderedBits(float f)
+{
+	f = f + 0.0f;
+
+	std::uint32_t bits;
+	std::memcpy(&bits, &f, sizeof(bits));
+
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+inline std::uint32_t OrderedBits(int i)
+{
+	return (std::uint32_t)i ^ 0x80000000u;
+}
+
+// Lexicographic order on (x, y) as one number
+inline std::uint64_t LexKey(std::uint32_t x, std::uint32_t y)
+{
+	return ((std::uint64_t)x << 32) | y;
+}
+
+// Spreads 32 bits out over the even bits of a 64-bit word
+inline std::uint64_t SpreadBits(std::uint32_t v)
+{
+	std::uint64_t x = v;
+	x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+	x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+	x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+	x = (x | (x << 2)) & 0x3333333333333333ull;
+	x = (x | (x << 1)) & 0x5555555555555555ull;
+	return x;
+}
+
+// Z-order on (x, y), so points that are close in the plane tend to be close in the array
+// On ordered float bits this is a Z-order of a slightly squashed plane, which is just as good for locality
+inline std::uint64_t MortonKey(std::uint32_t x, std::uint32_t y)
+{
+	return SpreadBits(x) | (SpreadBits(y) << 1);
+}
+
+// Squared distance as a key, so edges sort by length without a square root
+// Integers do it exactly; that's safe as long as coordinates stay under EXACT_COORD_LIMIT, like the predicates want
+inline std::uint64_t DistanceKey(int ax, int ay, int bx, int by)
+{
+	std::int64_t dx = (std::int64_t)bx - ax;
+	std::int64_t dy = (std::int64_t)by - ay;
+	return (std::uint64_t)(dx * dx) + (std::uint64_t)(dy * dy);
+}
+
+// A non-negative double's bits already sort the same way it does
+inline std::uint64_t DistanceKey(float ax, float ay, float bx, float by)
+{
+	double dx = (double)bx - ax;
+	double dy = (double)by - ay;
+	double d = dx * dx + dy * dy;
+
+	std::uint64_t bits;
+	std::memcpy(&bits, &d, sizeof(bits));
+	return bits;
+}
+
+//	--------------------------------------------------------
+//	The sort
+//	--------------------------------------------------------
+
+// Least-significant-digit radix sort, a byte at a time, stable
+// scratch gets resized to match; hand in the same one every time and it stops allocating
+// Bytes where every key agrees get skipped, which is most of the high ones for anything clustered
+inline void RadixSort(std::vector<RadixItem>& items, std::vector<RadixItem>& scratch)
+{
+	std::size_t n = items.size();
+	scratch.resize(n);
+
+	// Count every byte position in one pass
+	std::size_t counts[8][256];
+	std::memset(counts, 0, sizeof(counts));
+
+	for (std::size_t i = 0; i < n; i++)
+	{
+		std::uint64_t key = items[i].key;
+		for (int b = 0; b < 8; b++)
+		{
+			counts[b][(key >> (b * 8)) & 0xff]++;
+		}
+	}
+
+	RadixItem* from = items.data();
+	RadixItem* to = scratch.data();
+
+	for (int b = 0; b < 8; b++)
+	{
+		// Everything has the same byte here, so this pass wouldn't move anything
+		if (n == 0 || counts[b][(from[0].key >> (b * 8)) & 0xff] == n)
+		{
+			continue;
+		}
+
+		// Turn the counts into starting offsets
+		std::size_t offset = 0;
+		for (int d = 0; d < 256; d++)
+		{
+			std::size_t c = counts[b][d];
+			counts[b][d] = offset;
+			offset += c;
+		}
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			to[counts[b][(from[i].key >> (b * 8)) & 0xff]++] = from[i];
+		}
+
+		RadixItem* t = from;
+		from = to;
+		to = t;
+	}
+
+	// Make sure the answer ends up where the caller is looking
+	if (from != items.data())
+	{
+		items.swap(scratch);
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
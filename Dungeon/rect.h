@@ -10,7 +10,10 @@
 //	--------------------------------------------------------
 
 #include "edge.h"
+#include <algorithm>
+#include <cstdint>
 #include <random>
+#include <vector>
 #include "math.h"
 #include <unordered_set>
 #include <iostream>
@@ -70,6 +73,59 @@ public:
 
 //	--------------------------------------------------------
 
+// Lots of rects, one array per field, so a loop that only wants the lefts doesn't drag the heights through the cache
+// A rect's number is where it is in the arrays, and it keeps it until somebody clears them
+struct RectArrays
+{
+	std::vector<int> left;
+	std::vector<int> top;
+	std::vector<int> width;
+	std::vector<int> height;
+
+	std::size_t size() const							{ return left.size(); };
+	Rect at(std::uint32_t i) const						{ return Rect(left[i], top[i], width[i], height[i]); };
+
+	void Clear();
+	void Add(const Rect& r);
+
+	// Same answer as sf::Rect::intersects for rects with positive sizes, without working out where they overlap
+	bool Overlaps(std::uint32_t a, std::uint32_t b) const;
+
+	// Same, and if they do, how far across and down
+	bool Overlaps(std::uint32_t a, std::uint32_t b, int& across, int& down) const;
+};
+
+void RectArrays::Clear()
+{
+	left.clear();
+	top.clear();
+	width.clear();
+	height.clear();
+}
+
+void RectArrays::Add(const Rect& r)
+{
+	left.push_back(r.left);
+	top.push_back(r.top);
+	width.push_back(r.width);
+	height.push_back(r.height);
+}
+
+bool RectArrays::Overlaps(std::uint32_t a, std::uint32_t b) const
+{
+	return std::max(left[a], left[b]) < std::min(left[a] + width[a], left[b] + width[b]) &&
+		std::max(top[a], top[b]) < std::min(top[a] + height[a], top[b] + height[b]);
+}
+
+bool RectArrays::Overlaps(std::uint32_t a, std::uint32_t b, int& across, int& down) const
+{
+	across = std::min(left[a] + width[a], left[b] + width[b]) - std::max(left[a], left[b]);
+	down = std::min(top[a] + height[a], top[b] + height[b]) - std::max(top[a], top[b]);
+	return across > 0 && down > 0;
+}
+
+//	--------------------------------------------------------
+
 // Hash function extended for this type
 
 namespace std
@@ -27,6 +27,7 @@ private:
 	std::uniform_int_distribution<int>		die_;			// A die to roll for getting room sizes
 	std::uniform_int_distribution<int>		rgb_;			// A random RGB
 	std::uniform_real_distribution<float>	angle_;			// A random angle
+	std::uniform_real_distribution<float>	unit_;			// A random fraction
 public:
 	// Static everything
 	// Turns out the best way to do this is just to roll dice for the room dimensions
@@ -41,6 +42,7 @@ public:
 	int RoomDim();											// Generate random room dimension
 	Rect GetRoom();											// Create a random room
 	sf::Color GetColor();									// Generate a random color
+	float Chance();											// Somewhere in [0, 1)
 };
 
 DungeonRNG::DungeonRNG()
@@ -50,6 +52,7 @@ DungeonRNG::DungeonRNG()
 	die_ = std::uniform_int_distribution<int>(1, ROOM_DIE_SIZE);
 	angle_ = std::uniform_real_distribution<float>(0, 2 * M_PI);
 	rgb_ = std::uniform_int_distribution<int>(0, 255);
+	unit_ = std::uniform_real_distribution<float>(0, 1);
 }
 
 //	--------------------------------------------------------
@@ -83,6 +86,11 @@ sf::Color DungeonRNG::GetColor()
 	return sf::Color(rgb_(generator_), rgb_(generator_), rgb_(generator_), 255);
 }
 
+float DungeonRNG::Chance()
+{
+	return unit_(generator_);
+}
+
 //	--------------------------------------------------------
 //	Static utility functions
 //	--------------------------------------------------------
@@ -0,0 +1,383 @@
+//	--------------------------------------------------------
+//	SERIALIZE.H
+//	--------------------------------------------------------
+//	Contains a binary file format for finished triangulations, and a view that maps one straight into memory
+//	The file is the mesh's own arrays back to back, so loading is just pointing at them
+//	--------------------------------------------------------
+
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "topology.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//	--------------------------------------------------------
+//	The format
+//	--------------------------------------------------------
+
+// Bump this whenever the layout changes; old files get refused rather than misread
+const std::uint32_t TRIANGULATION_FILE_VERSION = 1;
+
+// Written as a number, so a file from a machine with the other byte order reads back wrong and gets refused
+const std::uint32_t TRIANGULATION_BYTE_ORDER = 0x01020304;
+
+// Every section starts on a multiple of this, so the arrays can be used right where they sit
+const std::uint64_t TRIANGULATION_ALIGNMENT = 8;
+
+// The arrays, in the order they appear
+enum TriangulationSection
+{
+	VERTS_SECTION,																	// BasicVert<T> per Vert
+	VERT_EDGES_SECTION,																// EdgeRef leaving each Vert, NIL if none
+	RECORDS_SECTION,																// EdgeRecord, four per QuadEdge, dead ones included
+	FACES_SECTION,																	// Vert per Voronoi vertex, which dual records point at
+	SOURCES_SECTION,																// Which input point each Vert came from
+	MST_SECTION,																	// EdgeRef per tree edge
+	VORONOI_SECTION,																// EdgeRef per Voronoi edge
+	SECTION_COUNT
+};
+
+struct TriangulationFileHeader
+{
+	char												magic[4];								// "DLNY"
+	std::uint32_t										version;
+	std::uint32_t										byteOrder;
+	std::uint32_t										coordSize;								// sizeof(T)
+	std::uint32_t										coordIntegral;							// 1 for int, 0 for float
+	std::uint32_t										padding;
+	EdgeArena											arena;									// So the free list survives the trip
+	std::uint32_t										padding2;
+	std::uint64_t										offset[SECTION_COUNT];					// From the start of the file
+	std::uint64_t										count[SECTION_COUNT];					// In elements, not bytes
+};
+
+//	--------------------------------------------------------
+//	Writing
+//	--------------------------------------------------------
+
+// Builds the triangulation, the MST and the Voronoi diagram if they aren't already, then writes all of it out
+// Returns false if the file couldn't be written
+template <typename T>
+bool SaveTriangulation(BasicDelaunay<T>& del, const char* path)
+{
+	EdgeList mst = del.GetMST();
+	EdgeList voronoi = del.GetVoronoi();
+
+	const BasicQuadEdgeMesh<T>& mesh = del.mesh();
+
+	std::vector<std::uint32_t> sources(mesh.vertCount());
+	for (VertRef v = 0; v < mesh.vertCount(); v++)
+	{
+		sources[v] = del.source(v);
+	}
+
+	const void* data[SECTION_COUNT] = { mesh.verts().data(), mesh.vertEdges().data(), mesh.records().data(), mesh.faces().data(), sources.data(), mst.data(), voronoi.data() };
+	std::uint64_t size[SECTION_COUNT] = { sizeof(BasicVert<T>), sizeof(EdgeRef), sizeof(EdgeRecord), sizeof(Vert), sizeof(std::uint32_t), sizeof(EdgeRef), sizeof(EdgeRef) };
+
+	TriangulationFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "DLNY", 4);
+	header.version = TRIANGULATION_FILE_VERSION;
+	header.byteOrder = TRIANGULATION_BYTE_ORDER;
+	header.coordSize = sizeof(T);
+	header.coordIntegral = std::is_integral<T>::value ? 1 : 0;
+	header.arena = mesh.arena();
+
+	header.count[VERTS_SECTION] = mesh.vertCount();
+	header.count[VERT_EDGES_SECTION] = mesh.vertCount();
+	header.count[RECORDS_SECTION] = mesh.records().size();
+	header.count[FACES_SECTION] = mesh.faceCount();
+	header.count[SOURCES_SECTION] = sources.size();
+	header.count[MST_SECTION] = mst.size();
+	header.count[VORONOI_SECTION] = voronoi.size();
+
+	// Lay the sections out back to back, each one rounded up to the alignment
+	std::uint64_t at = sizeof(header);
+	for (int s = 0; s < SECTION_COUNT; s++)
+	{
+		at = (at + TRIANGULATION_ALIGNMENT - 1) / TRIANGULATION_ALIGNMENT * TRIANGULATION_ALIGNMENT;
+		header.offset[s] = at;
+		at += header.count[s] * size[s];
+	}
+
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+	{
+		return false;
+	}
+
+	const char zeros[TRIANGULATION_ALIGNMENT] = { 0 };
+	out.write((const char*)&header, sizeof(header));
+	at = sizeof(header);
+
+	for (int s = 0; s < SECTION_COUNT; s++)
+	{
+		out.write(zeros, header.offset[s] - at);
+		out.write((const char*)data[s], header.count[s] * size[s]);
+		at = header.offset[s] + header.count[s] * size[s];
+	}
+
+	return (bool)out;
+}
+
+//	--------------------------------------------------------
+//	A file mapped into memory
+//	--------------------------------------------------------
+
+// Read only; the pages come in from disk as they're touched, so opening even a huge file is instant
+class MappedFile
+{
+private:
+	const char*											data_;
+	std::size_t											size_;
+
+#ifdef _WIN32
+	HANDLE												file_;
+	HANDLE												mapping_;
+#endif
+
+	void												Close();
+
+	// No copying; we own the mapping
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile(const char* path);
+	~MappedFile()																{ Close(); };
+
+	bool												IsOpen() const							{ return data_ != NULL; };
+	const char*											data() const							{ return data_; };
+	std::size_t											size() const							{ return size_; };
+};
+
+#ifdef _WIN32
+
+inline MappedFile::MappedFile(const char* path) : data_(NULL), size_(0), file_(INVALID_HANDLE_VALUE), mapping_(NULL)
+{
+	file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_ == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return;
+	}
+
+	mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping_ == NULL)
+	{
+		Close();
+		return;
+	}
+
+	data_ = (const char*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	size_ = (data_ != NULL) ? (std::size_t)size.QuadPart : 0;
+}
+
+inline void MappedFile::Close()
+{
+	if (data_ != NULL)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_ != NULL)
+	{
+		CloseHandle(mapping_);
+	}
+	if (file_ != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(file_);
+	}
+
+	data_ = NULL;
+	size_ = 0;
+	mapping_ = NULL;
+	file_ = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+inline MappedFile::MappedFile(const char* path) : data_(NULL), size_(0)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 && info.st_size > 0)
+	{
+		void* p = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p != MAP_FAILED)
+		{
+			data_ = (const char*)p;
+			size_ = info.st_size;
+		}
+	}
+
+	// The mapping keeps the file alive on its own
+	close(fd);
+}
+
+inline void MappedFile::Close()
+{
+	if (data_ != NULL)
+	{
+		munmap((void*)data_, size_);
+	}
+
+	data_ = NULL;
+	size_ = 0;
+}
+
+#endif
+
+//	--------------------------------------------------------
+//	The view
+//	--------------------------------------------------------
+
+// A finished triangulation, straight out of a file
+// Nothing gets parsed or copied; every accessor reads the mapped arrays, which is why it can't be edited
+// Walks the same way the mesh does, so anything written against Onext and Org reads the same here
+template <typename T>
+class BasicTriangulationView
+{
+public:
+	typedef BasicVert<T>								VertType;
+
+private:
+	MappedFile											file_;
+	const TriangulationFileHeader*						header_;
+
+	const VertType*										verts_;
+	const EdgeRef*										vertEdges_;
+	const EdgeRecord*									edges_;
+	const Vert*											faces_;
+	const std::uint32_t*								sources_;
+	const EdgeRef*										mst_;
+	const EdgeRef*										voronoi_;
+
+	bool												Check();
+	const void*											Section(int s) const					{ return file_.data() + header_->offset[s]; };
+
+public:
+	// Check IsOpen afterward; a missing file, a different version or the wrong coordinate type all leave it closed
+	BasicTriangulationView(const char* path);
+
+	bool												IsOpen() const							{ return header_ != NULL; };
+
+	// The same walking as the mesh
+	EdgeRef												Onext(EdgeRef e) const					{ return edges_[e].next; };
+	EdgeRef												Oprev(EdgeRef e) const					{ return Rot(Onext(Rot(e))); };
+	EdgeRef												Lnext(EdgeRef e) const					{ return Rot(Onext(InvRot(e))); };
+	VertRef												Org(EdgeRef e) const					{ return edges_[e].origin; };
+	VertRef												Dest(EdgeRef e) const					{ return edges_[Sym(e)].origin; };
+	const VertType&										origin(EdgeRef e) const					{ return verts_[Org(e)]; };
+	const VertType&										destination(EdgeRef e) const			{ return verts_[Dest(e)]; };
+	const Vert&											dualOrigin(EdgeRef e) const				{ return faces_[edges_[e].origin]; };
+
+	const VertType&										vert(VertRef v) const					{ return verts_[v]; };
+	EdgeRef												edge(VertRef v) const					{ return vertEdges_[v]; };
+	std::uint32_t										source(VertRef v) const					{ return sources_[v]; };
+	std::uint32_t										vertCount() const						{ return header_->count[VERTS_SECTION]; };
+
+	std::uint32_t										quadCapacity() const					{ return header_->count[RECORDS_SECTION] / 4; };
+	bool												IsLive(std::uint32_t quad) const		{ return edges_[quad * 4].origin != NIL; };
+
+	const Vert&											face(std::uint32_t f) const				{ return faces_[f]; };
+	std::uint32_t										faceCount() const						{ return header_->count[FACES_SECTION]; };
+
+	// The side tables, as they were when the file was saved
+	const EdgeRef*										mst() const								{ return mst_; };
+	std::uint32_t										mstCount() const						{ return header_->count[MST_SECTION]; };
+	const EdgeRef*										voronoi() const							{ return voronoi_; };
+	std::uint32_t										voronoiCount() const					{ return header_->count[VORONOI_SECTION]; };
+};
+
+typedef BasicTriangulationView<float>					TriangulationView;
+typedef BasicTriangulationView<int>						IntTriangulationView;
+
+template <typename T>
+BasicTriangulationView<T>::BasicTriangulationView(const char* path) : file_(path), header_(NULL)
+{
+	if (!file_.IsOpen() || file_.size() < sizeof(TriangulationFileHeader))
+	{
+		return;
+	}
+
+	header_ = (const TriangulationFileHeader*)file_.data();
+
+	if (!Check())
+	{
+		header_ = NULL;
+		return;
+	}
+
+	verts_ = (const VertType*)Section(VERTS_SECTION);
+	vertEdges_ = (const EdgeRef*)Section(VERT_EDGES_SECTION);
+	edges_ = (const EdgeRecord*)Section(RECORDS_SECTION);
+	faces_ = (const Vert*)Section(FACES_SECTION);
+	sources_ = (const std::uint32_t*)Section(SOURCES_SECTION);
+	mst_ = (const EdgeRef*)Section(MST_SECTION);
+	voronoi_ = (const EdgeRef*)Section(VORONOI_SECTION);
+}
+
+template <typename T>
+bool BasicTriangulationView<T>::Check()
+{
+	if (std::memcmp(header_->magic, "DLNY", 4) != 0 || header_->version != TRIANGULATION_FILE_VERSION || header_->byteOrder != TRIANGULATION_BYTE_ORDER)
+	{
+		return false;
+	}
+
+	if (header_->coordSize != sizeof(T) || header_->coordIntegral != (std::is_integral<T>::value ? 1u : 0u))
+	{
+		return false;
+	}
+
+	// A truncated file would have us reading off the end of the mapping
+	const std::uint64_t size[SECTION_COUNT] = { sizeof(VertType), sizeof(EdgeRef), sizeof(EdgeRecord), sizeof(Vert), sizeof(std::uint32_t), sizeof(EdgeRef), sizeof(EdgeRef) };
+	for (int s = 0; s < SECTION_COUNT; s++)
+	{
+		if (header_->offset[s] % TRIANGULATION_ALIGNMENT != 0 || header_->offset[s] + header_->count[s] * size[s] > file_.size())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	--------------------------------------------------------
+
+#endif
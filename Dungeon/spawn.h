@@ -0,0 +1,252 @@
+//	--------------------------------------------------------
+//	SPAWN.H
+//	--------------------------------------------------------
+//	Contains Poisson-disk room placement, for starting the rooms out mostly apart instead of all on top of each other
+//	--------------------------------------------------------
+
+#ifndef SPAWN_H
+#define SPAWN_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include "rect.h"
+#include "rng.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//	--------------------------------------------------------
+//	Constants
+//	--------------------------------------------------------
+
+// How many places to try around a room before giving up on it
+const int									SPAWN_TRIES = 30;
+
+// About how much of the disk the rooms take up; random placement stalls out somewhere past half
+const float									SPAWN_DENSITY = 0.5f;
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+// Bridson's sampling, except every sample is a room with its own dice-roll size
+// Each room gets its size rolled before it's placed and keeps it until it lands, so the rooms that fit easier don't win out
+// A new room gets thrown at a ring around some room that's already down, just far enough out for the two of them to miss,
+// and sticks if it doesn't overlap anything and its center's in the disk; a room that runs out of tries stops getting used
+// The disk grows with the square root of the room count, so the rooms cover about the same fraction of it however many there are
+// If the disk fills up first, whoever's left lands anywhere in it, and the drift sorts them out
+class PoissonSpawner
+{
+private:
+	DungeonRNG&									rng_;
+
+	// Where the rooms are, and which ones can still have rooms thrown around them
+	RectArrays									rooms_;
+	std::vector<std::uint32_t>					active_;
+
+	// Cells as big as the biggest room, over the square around the disk; a room is in every cell it covers, which is four at most
+	// Two rooms that overlap share a cell, so a new room only has to look in its own cells
+	int											radius_;
+	int											cellSize_;
+	int											columns_;
+	std::vector<std::vector<std::uint32_t>>		cells_;
+
+	int											Cell(int x, int y) const;
+	int											Cells(const Rect& r, int* cells) const;
+	bool										Fits(const Rect& r) const;
+	void										Place(const Rect& r);
+	Rect										Centered(float x, float y, int width, int height) const;
+
+public:
+	PoissonSpawner(DungeonRNG& rng);
+
+	// n rooms, mostly not overlapping, around the origin
+	void										Spawn(int n, std::vector<Rect>& out);
+};
+
+//	--------------------------------------------------------
+//	Constructor
+//	--------------------------------------------------------
+
+PoissonSpawner::PoissonSpawner(DungeonRNG& rng) : rng_(rng), radius_(0), cellSize_(1), columns_(0)
+{
+
+}
+
+//	--------------------------------------------------------
+//	Helpers
+//	--------------------------------------------------------
+
+int PoissonSpawner::Cell(int x, int y) const
+{
+	return ((y + radius_ + cellSize_) / cellSize_) * columns_ + (x + radius_ + cellSize_) / cellSize_;
+}
+
+int PoissonSpawner::Cells(const Rect& r, int* cells) const
+{
+	// Rooms are never bigger than a cell, so the corners land in every cell the room's in
+	int corners[4] = {
+		Cell(r.left, r.top),
+		Cell(r.left + r.width - 1, r.top),
+		Cell(r.left, r.top + r.height - 1),
+		Cell(r.left + r.width - 1, r.top + r.height - 1)
+	};
+
+	int count = 0;
+
+	for (int c = 0; c < 4; c++)
+	{
+		if (std::find(cells, cells + count, corners[c]) == cells + count)
+		{
+			cells[count++] = corners[c];
+		}
+	}
+
+	return count;
+}
+
+bool PoissonSpawner::Fits(const Rect& r) const
+{
+	int cells[4];
+	int count = Cells(r, cells);
+
+	for (int c = 0; c < count; c++)
+	{
+		const std::vector<std::uint32_t>& cell = cells_[cells[c]];
+
+		for (std::size_t k = 0; k < cell.size(); k++)
+		{
+			std::uint32_t j = cell[k];
+
+			if (std::max(r.left, rooms_.left[j]) < std::min(r.left + r.width, rooms_.left[j] + rooms_.width[j]) &&
+				std::max(r.top, rooms_.top[j]) < std::min(r.top + r.height, rooms_.top[j] + rooms_.height[j]))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void PoissonSpawner::Place(const Rect& r)
+{
+	std::uint32_t i = rooms_.size();
+	rooms_.Add(r);
+	active_.push_back(i);
+
+	int cells[4];
+	int count = Cells(r, cells);
+
+	for (int c = 0; c < count; c++)
+	{
+		cells_[cells[c]].push_back(i);
+	}
+}
+
+Rect PoissonSpawner::Centered(float x, float y, int width, int height) const
+{
+	return Rect((int)floor(x) - width / 2, (int)floor(y) - height / 2, width, height);
+}
+
+//	--------------------------------------------------------
+//	Spawning
+//	--------------------------------------------------------
+
+void PoissonSpawner::Spawn(int n, std::vector<Rect>& out)
+{
+	out.clear();
+	rooms_.Clear();
+	active_.clear();
+
+	if (n <= 0)
+	{
+		return;
+	}
+
+	// The average room is a die's average times the dice each way
+	float side = DungeonRNG::ROOM_DICE * (DungeonRNG::ROOM_DIE_SIZE + 1) / 2.0f;
+	radius_ = (int)ceil(sqrt(n * side * side / (M_PI * SPAWN_DENSITY)));
+	cellSize_ = DungeonRNG::ROOM_DICE * DungeonRNG::ROOM_DIE_SIZE;
+
+	// A room's center stays in the disk, so the room stays within half a cell of it; one cell of slack each side covers that
+	columns_ = (2 * radius_ + 2 * cellSize_) / cellSize_ + 1;
+	cells_.assign((std::size_t)columns_ * columns_, std::vector<std::uint32_t>());
+
+	int width = rng_.RoomDim();
+	int height = rng_.RoomDim();
+	Place(Centered(0.0f, 0.0f, width, height));
+
+	width = rng_.RoomDim();
+	height = rng_.RoomDim();
+
+	while ((int)rooms_.size() < n && !active_.empty())
+	{
+		std::size_t a = std::min<std::size_t>((std::size_t)(rng_.Chance() * active_.size()), active_.size() - 1);
+		Rect from = rooms_.at(active_[a]);
+
+		// Far enough that the two would just about miss side by side, and no more than twice that
+		float cx = from.left + from.width / 2.0f;
+		float cy = from.top + from.height / 2.0f;
+		float reach = (std::max(from.width, from.height) + std::max(width, height)) / 2.0f;
+		bool placed = false;
+
+		for (int t = 0; t < SPAWN_TRIES && !placed; t++)
+		{
+			float theta = 2 * M_PI * rng_.Chance();
+			float d = reach * (1.0f + rng_.Chance());
+			float x = cx + d * cos(theta);
+			float y = cy + d * sin(theta);
+
+			if (x * x + y * y > (float)radius_ * radius_)
+			{
+				continue;
+			}
+
+			Rect r = Centered(x, y, width, height);
+
+			if (Fits(r))
+			{
+				Place(r);
+				placed = true;
+			}
+		}
+
+		if (placed)
+		{
+			width = rng_.RoomDim();
+			height = rng_.RoomDim();
+		}
+		else
+		{
+			active_[a] = active_.back();
+			active_.pop_back();
+		}
+	}
+
+	// Full up; the rest go anywhere in the disk, uniformly, and overlap whoever's there
+	while ((int)rooms_.size() < n)
+	{
+		float theta = 2 * M_PI * rng_.Chance();
+		float d = radius_ * sqrt(rng_.Chance());
+		rooms_.Add(Centered(d * cos(theta), d * sin(theta), width, height));
+
+		width = rng_.RoomDim();
+		height = rng_.RoomDim();
+	}
+
+	out.reserve(n);
+
+	for (std::uint32_t i = 0; i < rooms_.size(); i++)
+	{
+		out.push_back(rooms_.at(i));
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
@@ -0,0 +1,183 @@
+//	--------------------------------------------------------
+//	STATS.H
+//	--------------------------------------------------------
+//	Contains counters for the triangulation's hot paths, for finding out why one input is slower than another
+//	Define DELAUNAY_STATS before including anything to turn them on; otherwise every counter compiles to nothing
+//	--------------------------------------------------------
+
+#ifndef STATS_H
+#define STATS_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+
+#ifdef DELAUNAY_STATS
+#include <atomic>
+#include <chrono>
+#endif
+
+//	--------------------------------------------------------
+//	The report
+//	--------------------------------------------------------
+
+// Merges get bucketed by the log of how many points they join, which is the recursion depth counted from the bottom
+const int STATS_LEVELS = 32;
+
+// What one triangulation did; all zeros unless DELAUNAY_STATS is on
+struct TriangulationStats
+{
+	// Predicates, and how often the floating-point filter couldn't decide so we went exact
+	// Integer coordinates are always exact, so their exact counts stay zero
+	// Ties are in-circle tests that came out exactly zero and had to be broken symbolically
+	std::uint64_t										orientCalls;
+	std::uint64_t										orientExact;
+	std::uint64_t										inCircleCalls;
+	std::uint64_t										inCircleExact;
+	std::uint64_t										inCircleTies;
+
+	// Topology
+	std::uint64_t										edgesMade;
+	std::uint64_t										splices;
+	std::uint64_t										kills;
+
+	// Per level: how many merges, how many steps finding the lower tangents, and how many rungs zipping up
+	std::uint64_t										merges[STATS_LEVELS];
+	std::uint64_t										tangentSteps[STATS_LEVELS];
+	std::uint64_t										mergeSteps[STATS_LEVELS];
+
+	// Wall time in milliseconds, for putting the points in order and for the triangulation itself
+	double												sortMs;
+	double												triangulateMs;
+
+	void												Print(std::ostream& out) const;
+};
+
+inline void TriangulationStats::Print(std::ostream& out) const
+{
+	out << "sort " << sortMs << " ms, triangulate " << triangulateMs << " ms" << std::endl;
+	out << "orient " << orientCalls << " (" << orientExact << " exact), incircle " << inCircleCalls << " (" << inCircleExact << " exact, " << inCircleTies << " ties)" << std::endl;
+	out << "edges made " << edgesMade << ", splices " << splices << ", kills " << kills << std::endl;
+	out << std::setw(8) << "level" << std::setw(12) << "merges" << std::setw(16) << "tangent steps" << std::setw(14) << "merge steps" << std::endl;
+
+	for (int level = 0; level < STATS_LEVELS; level++)
+	{
+		if (merges[level] > 0)
+		{
+			out << std::setw(8) << level << std::setw(12) << merges[level] << std::setw(16) << tangentSteps[level] << std::setw(14) << mergeSteps[level] << std::endl;
+		}
+	}
+}
+
+//	--------------------------------------------------------
+//	The counters
+//	--------------------------------------------------------
+
+#ifdef DELAUNAY_STATS
+
+// Shared by every thread, so a parallel triangulation counts everything; relaxed, since only the totals matter
+// That also means two triangulations running at once land in the same counters
+struct KernelCounters
+{
+	std::atomic<std::uint64_t>							orientCalls;
+	std::atomic<std::uint64_t>							orientExact;
+	std::atomic<std::uint64_t>							inCircleCalls;
+	std::atomic<std::uint64_t>							inCircleExact;
+	std::atomic<std::uint64_t>							inCircleTies;
+	std::atomic<std::uint64_t>							edgesMade;
+	std::atomic<std::uint64_t>							splices;
+	std::atomic<std::uint64_t>							kills;
+	std::atomic<std::uint64_t>							merges[STATS_LEVELS];
+	std::atomic<std::uint64_t>							tangentSteps[STATS_LEVELS];
+	std::atomic<std::uint64_t>							mergeSteps[STATS_LEVELS];
+};
+
+inline KernelCounters& Counters()
+{
+	static KernelCounters counters;
+	return counters;
+}
+
+// Which level the merge this thread is in the middle of belongs to
+inline int& StatsLevel()
+{
+	static thread_local int level = 0;
+	return level;
+}
+
+// Milliseconds since whenever; only good for subtracting
+inline double StatsClock()
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int StatsLevelOf(std::uint32_t points)
+{
+	int level = 0;
+	while (points > 1 && level < STATS_LEVELS - 1)
+	{
+		points >>= 1;
+		level++;
+	}
+	return level;
+}
+
+inline void ResetCounters()
+{
+	KernelCounters& c = Counters();
+	c.orientCalls = 0;
+	c.orientExact = 0;
+	c.inCircleCalls = 0;
+	c.inCircleExact = 0;
+	c.inCircleTies = 0;
+	c.edgesMade = 0;
+	c.splices = 0;
+	c.kills = 0;
+
+	for (int level = 0; level < STATS_LEVELS; level++)
+	{
+		c.merges[level] = 0;
+		c.tangentSteps[level] = 0;
+		c.mergeSteps[level] = 0;
+	}
+}
+
+inline void ReadCounters(TriangulationStats& stats)
+{
+	KernelCounters& c = Counters();
+	stats.orientCalls = c.orientCalls;
+	stats.orientExact = c.orientExact;
+	stats.inCircleCalls = c.inCircleCalls;
+	stats.inCircleExact = c.inCircleExact;
+	stats.inCircleTies = c.inCircleTies;
+	stats.edgesMade = c.edgesMade;
+	stats.splices = c.splices;
+	stats.kills = c.kills;
+
+	for (int level = 0; level < STATS_LEVELS; level++)
+	{
+		stats.merges[level] = c.merges[level];
+		stats.tangentSteps[level] = c.tangentSteps[level];
+		stats.mergeSteps[level] = c.mergeSteps[level];
+	}
+}
+
+#define DELAUNAY_COUNT(name)				(Counters().name.fetch_add(1, std::memory_order_relaxed))
+#define DELAUNAY_COUNT_LEVEL(name)			(Counters().name[StatsLevel()].fetch_add(1, std::memory_order_relaxed))
+#define DELAUNAY_SET_LEVEL(points)			(StatsLevel() = StatsLevelOf(points))
+
+#else
+
+#define DELAUNAY_COUNT(name)				((void)0)
+#define DELAUNAY_COUNT_LEVEL(name)			((void)0)
+#define DELAUNAY_SET_LEVEL(points)			((void)0)
+
+#endif
+
+//	--------------------------------------------------------
+
+#endif
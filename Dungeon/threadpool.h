@@ -0,0 +1,240 @@
+//	--------------------------------------------------------
+//	THREADPOOL.H
+//	--------------------------------------------------------
+//	Contains a small work-stealing thread pool for fork/join style recursion
+//	Each thread pushes and pops its own deque from the back; idle threads steal from the front of everyone else's
+//	--------------------------------------------------------
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+//	--------------------------------------------------------
+//	Include
+//	--------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//	--------------------------------------------------------
+//	A unit of work
+//	--------------------------------------------------------
+
+// Lives on the stack of whoever forked it; they have to Wait on it before it goes out of scope
+class PoolTask
+{
+private:
+	std::function<void()>								work_;
+	std::atomic<bool>									done_;
+
+	friend class ThreadPool;
+
+public:
+	PoolTask(std::function<void()> work) : work_(work), done_(false) {};
+
+	bool												done() const							{ return done_.load(std::memory_order_acquire); };
+};
+
+//	--------------------------------------------------------
+//	The class
+//	--------------------------------------------------------
+
+class ThreadPool
+{
+private:
+	// One deque per worker, plus one at the end for threads that don't belong to us
+	struct Queue
+	{
+		std::mutex										lock;
+		std::deque<PoolTask*>							tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>>					queues_;
+	std::vector<std::thread>							threads_;
+
+	// Sleeping workers wait on this until something shows up
+	std::atomic<bool>									stop_;
+	std::atomic<int>									pending_;
+	std::mutex											sleepLock_;
+	std::condition_variable								wake_;
+
+	// Which pool and queue the calling thread works for, if any
+	static thread_local ThreadPool*						currentPool_;
+	static thread_local int								currentQueue_;
+
+	int													MyQueue();
+	PoolTask*											FindTask(int self);
+	void												Run(PoolTask* task);
+	void												WorkerLoop(int index);
+
+	// No copying; we own threads
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+public:
+	// Zero threads means one per hardware thread
+	ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+
+	unsigned											threadCount() const						{ return threads_.size(); };
+
+	// Fork a task, then join on it; waiting threads run other tasks instead of blocking
+	void												Submit(PoolTask* task);
+	void												Wait(PoolTask* task);
+};
+
+thread_local ThreadPool* ThreadPool::currentPool_ = NULL;
+thread_local int ThreadPool::currentQueue_ = -1;
+
+//	--------------------------------------------------------
+//	Constructors and destructors
+//	--------------------------------------------------------
+
+ThreadPool::ThreadPool(unsigned threads) : stop_(false), pending_(0)
+{
+	if (threads == 0)
+	{
+		threads = std::thread::hardware_concurrency();
+		threads = (threads == 0) ? 1 : threads;
+	}
+
+	for (unsigned i = 0; i <= threads; i++)
+	{
+		queues_.push_back(std::unique_ptr<Queue>(new Queue()));
+	}
+
+	for (unsigned i = 0; i < threads; i++)
+	{
+		threads_.push_back(std::thread(&ThreadPool::WorkerLoop, this, (int)i));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleepLock_);
+		stop_ = true;
+	}
+	wake_.notify_all();
+
+	for (auto t = threads_.begin(); t != threads_.end(); t++)
+	{
+		t->join();
+	}
+}
+
+//	--------------------------------------------------------
+//	Scheduling
+//	--------------------------------------------------------
+
+int ThreadPool::MyQueue()
+{
+	// Outsiders all share the last queue
+	return (currentPool_ == this) ? currentQueue_ : (int)queues_.size() - 1;
+}
+
+void ThreadPool::Submit(PoolTask* task)
+{
+	Queue& q = *queues_[MyQueue()];
+
+	{
+		std::lock_guard<std::mutex> guard(q.lock);
+		q.tasks.push_back(task);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(sleepLock_);
+		pending_++;
+	}
+	wake_.notify_one();
+}
+
+PoolTask* ThreadPool::FindTask(int self)
+{
+	// Newest work from our own queue first, since it's the hottest in cache
+	{
+		Queue& q = *queues_[self];
+		std::lock_guard<std::mutex> guard(q.lock);
+		if (!q.tasks.empty())
+		{
+			PoolTask* task = q.tasks.back();
+			q.tasks.pop_back();
+			pending_--;
+			return task;
+		}
+	}
+
+	// Otherwise steal the oldest (and so probably biggest) task from somebody else
+	for (std::size_t i = 1; i < queues_.size(); i++)
+	{
+		Queue& q = *queues_[(self + i) % queues_.size()];
+		std::lock_guard<std::mutex> guard(q.lock);
+		if (!q.tasks.empty())
+		{
+			PoolTask* task = q.tasks.front();
+			q.tasks.pop_front();
+			pending_--;
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+void ThreadPool::Run(PoolTask* task)
+{
+	task->work_();
+	task->done_.store(true, std::memory_order_release);
+}
+
+void ThreadPool::Wait(PoolTask* task)
+{
+	int self = MyQueue();
+
+	// Keep busy until the thing we want is finished
+	while (!task->done())
+	{
+		PoolTask* other = FindTask(self);
+
+		if (other != NULL)
+		{
+			Run(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ThreadPool::WorkerLoop(int index)
+{
+	currentPool_ = this;
+	currentQueue_ = index;
+
+	while (!stop_)
+	{
+		PoolTask* task = FindTask(index);
+
+		if (task != NULL)
+		{
+			Run(task);
+		}
+		else
+		{
+			// Nap until someone submits something; the timeout covers a notify we raced past
+			std::unique_lock<std::mutex> lock(sleepLock_);
+			wake_.wait_for(lock, std::chrono::milliseconds(1), [this] { return stop_ || pending_ > 0; });
+		}
+	}
+}
+
+//	--------------------------------------------------------
+
+#endif
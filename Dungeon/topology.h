@@ -9,16 +9,21 @@
 #define TOPOLOGY_H
 
 //	--------------------------------------------------------
-//	Include files	
+//	Include files
 //	--------------------------------------------------------
 
 #include "edge.h"
+#include "graph.h"
 #include "linal.h"
 #include "quadedge.h"
 #include "math.h"
+#include "radix.h"
 #include "rect.h"
+#include "stats.h"
+#include "threadpool.h"
 
-#include <tuple>
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include <memory>
@@ -29,235 +34,677 @@
 //	Some typedefs for readability
 //	--------------------------------------------------------
 
-typedef std::vector<Edge*>					EdgeList;
-typedef std::vector<Vert*>					PointsList;
-typedef std::vector<QuadEdge*>				QuadList;
-typedef std::tuple<EdgeList, EdgeList>		EdgePartition;
-typedef std::tuple<PointsList, PointsList>	PointsPartition;
+typedef std::vector<EdgeRef>				EdgeList;
+typedef std::vector<VertRef>				PointsList;
+
+// What triangulating a run of points hands back: the counterclockwise hull edge out of its leftmost point,
+// and the clockwise hull edge out of its rightmost point
+typedef std::pair<EdgeRef, EdgeRef>			EdgePartition;
+
+//	--------------------------------------------------------
+//	Tuning
+//	--------------------------------------------------------
+
+// Below this many points it's cheaper to just recurse than to hand half the work to another thread
+const std::size_t							PARALLEL_CUTOFF = 4096;
+
+// Halving 2^32 points bottoms out well before this, so the explicit stack can live on the real one
+const int									TRIANGULATE_MAX_DEPTH = 64;
+
+// The Voronoi cells as one flat array, compressed-sparse-row style
+// Cell v is the faces faces[offsets[v]] to faces[offsets[v + 1] - 1], counterclockwise around Vert v
+// A cell on the hull is open, and ends with NIL where it runs off to infinity; removed Verts get empty cells
+struct VoronoiCells
+{
+	std::vector<std::uint32_t>				offsets;
+	std::vector<std::uint32_t>				faces;
+};
+
+// The triangulation laid out flat, for anything that would rather walk arrays than chase edges
+// Vert v's neighbors are neighbors[offsets[v]] to neighbors[offsets[v + 1] - 1], counterclockwise
+// triangles has three Verts per triangle, counterclockwise; hull is the convex hull, counterclockwise, first Vert not repeated
+struct TriangulationExport
+{
+	std::vector<std::uint32_t>				offsets;
+	std::vector<VertRef>					neighbors;
+	std::vector<VertRef>					triangles;
+	std::vector<VertRef>					hull;
+};
+
+// How GetMST finds its tree
+// Kruskal sorts every edge by length and is the quickest on a triangulation, where edges are only three times the Verts
+// Prim grows the tree out from one Vert at a time with a heap, which is handy if you want to stop early
+enum MSTMethod
+{
+	KRUSKAL_MST,
+	PRIM_MST
+};
+
+// How the recursion divides up the points
+// Vertical cuts split the x-sorted list in half every time, which leaves long skinny strips near the bottom
+// Alternating cuts (Dwyer 1987) take the median in x, then in y, then x again, so the pieces stay roughly square
+// and the merges stay short; that's a win on anything that looks like a uniform cloud
+enum CutStrategy
+{
+	VERTICAL_CUTS,
+	ALTERNATING_CUTS
+};
 
 //	--------------------------------------------------------
 // The class, creatively named, that will house our methods
 //	--------------------------------------------------------
 
-class Delaunay
+// T is the coordinate type; integer coordinates get exact predicates with no floating-point filter at all
+template <typename T>
+class BasicDelaunay
 {
+public:
+	typedef BasicVert<T>					VertType;
+	typedef BasicQuadEdgeMesh<T>			MeshType;
+
 private:
 	// Components of the graph
+	// The mesh owns the memory; the list just remembers the order
+	MeshType								mesh_;
 	PointsList								vertices_;
-	QuadList								edges_;
+
+	// Where each mesh Vert came from in the caller's points, since sorting and deduping shuffles them
+	PointsList								sources_;
+
+	// Buffers for the presort, kept around so the next Reset doesn't allocate them again
+	std::vector<RadixItem>					sortItems_;
+	std::vector<RadixItem>					sortScratch_;
+
+	// Somebody else's threads, if we're allowed to use them
+	ThreadPool*								pool_;
+
+	// Whether the serial part of the recursion runs off a fixed array of frames instead of the call stack
+	bool									explicitStack_;
+
+	// Which way we cut the points
+	CutStrategy								cuts_;
+
+	// Bookkeeping for editing the triangulation after it's built
+	// Removed Verts stay in the mesh and in vertices_, flagged, until the next rebuild sweeps them out
+	bool									built_;
+	bool									sorted_;
+	std::vector<bool>						removed_;
+	std::uint32_t							removedCount_;
+
+	// Where the last edit happened, so the next walk starts somewhere nearby
+	EdgeRef									lastEdge_;
+
+	// Scratch lists for edits, kept around so edits don't allocate
+	EdgeList								suspects_;
+	EdgeList								ring_;
+	EdgeList								boundary_;
+
+	// The Voronoi diagram, cached until the triangulation changes
+	// triangles_ has three Verts per face, counterclockwise, in face order
+	std::vector<VertRef>					triangles_;
+	EdgeList								voronoi_;
+	VoronoiCells							cells_;
+	bool									facesBuilt_;
+	bool									cellsBuilt_;
+
+	// Scratch for the spanning tree
+	DisjointSets							sets_;
+	IndexedHeap								heap_;
+	EdgeList								via_;
+	std::vector<bool>						inTree_;
+
+	// Scratch for searching outward from a Vert; touched_ is everyone seen_ needs unmarking afterward
+	std::vector<RadixItem>					frontier_;
+	std::vector<bool>						seen_;
+	EdgeList								touched_;
+
+	// What the last build did, if we're counting
+	TriangulationStats						stats_;
+
+	// Goes up every time the triangulation changes, so anyone drawing it knows when to redo their copy
+	std::uint32_t							version_;
+
+	// Every constructor starts here: default settings, nothing loaded
+	BasicDelaunay();
+
+	// Forget the points and everything built from them, but keep the settings and the memory
+	void									Clear();
 
 	// Helper to create a bunch of random vertices
 	void									GenerateRandomVerts(int n);
 
-	// Helper to cut the array of points in half
-	PointsPartition							SplitPoints(const PointsList& points);
+	// Helper to turn a buffer of coordinates into mesh Verts
+	void									LoadVerts(std::vector<std::vector<T>>& buffer);
+
+	// Helper to sort, dedupe and load a flat run of points, optionally storing them in Morton order
+	void									LoadSpan(const VertType* points, std::size_t count, bool morton);
 
 	// Functions that create or remove edges
-	Edge*									MakeEdgeBetween(int a, int b, const PointsList& points);
-	Edge*									Connect(Edge* a, Edge* b);
-	void									Kill(Edge* edge);
+	// Everything that allocates takes the arena of whichever subproblem it's working on, so threads never share one
+	EdgeRef									MakeEdgeBetween(VertRef a, VertRef b, EdgeArena& arena);
+	EdgeRef									Connect(EdgeRef a, EdgeRef b, EdgeArena& arena);
+	void									Kill(EdgeRef edge, EdgeArena& arena);
 
 	// Functions for generating primitive shapes that we'll merge together
-	EdgePartition							LinePrimitive(const PointsList& points);
-	EdgePartition							TrianglePrimitive(const PointsList& points);
+	// Both work on vertices_[lo, hi), which has to be two or three points long
+	EdgePartition							LinePrimitive(std::uint32_t lo, EdgeArena& arena);
+	EdgePartition							TrianglePrimitive(std::uint32_t lo, EdgeArena& arena);
+	EdgePartition							Primitive(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena);
+
+	// Helpers for cutting along either axis
+	// Axis 0 orders by (x, y); axis 1 orders by (y, -x), which is the same thing turned a quarter turn clockwise
+	// Turning doesn't change any orientation test, so the merge is happy with either one as long as both halves agree
+	bool									KeyLess(VertRef a, VertRef b, int axis) const;
+	int										ChildAxis(int axis) const				{ return (cuts_ == ALTERNATING_CUTS) ? 1 - axis : axis; };
+	std::uint32_t							Split(std::uint32_t lo, std::uint32_t hi, int axis);
+	EdgePartition							Reframe(EdgePartition hull, int axis) const;
 
 	// Refactored subroutines to make the big algorithm more readable
-	Edge*									LowestCommonTangent(Edge*& left_inner, Edge*& right_inner);
-	Edge*									LeftCandidate(Edge* base_edge);
-	Edge*									RightCandidate(Edge* base_edge);
-	void									MergeHulls(Edge*& base_edge);
-
-	// The main attraction
-	EdgePartition							Triangulate(const PointsList& points);
+	EdgeRef									LowestCommonTangent(EdgeRef& left_inner, EdgeRef& right_inner, EdgeArena& arena);
+	EdgeRef									LeftCandidate(EdgeRef base_edge, EdgeArena& arena);
+	EdgeRef									RightCandidate(EdgeRef base_edge, EdgeArena& arena);
+	void									MergeHulls(EdgeRef& base_edge, EdgeArena& arena);
+	EdgePartition							Merge(EdgePartition left, EdgePartition right, int axis, EdgeArena& arena);
+
+	// The main attraction, on the run vertices_[lo, hi), cutting across the given axis
+	// The first one recurses (and forks, if there's a pool); the second one loops over an explicit stack
+	EdgePartition							Triangulate(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena);
+	EdgePartition							TriangulateIterative(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena);
+
+	// Triangulate whatever's in vertices_ from scratch; Rebuild throws the old edges away first
+	void									Build();
+	void									Rebuild();
+
+	// Helpers for editing
+	bool									IsRemoved(VertRef v) const				{ return v < removed_.size() && removed_[v]; };
+	std::uint32_t							LiveCount() const						{ return vertices_.size() - removedCount_; };
+	bool									IsFlat() const							{ return mesh_.quadCount() + 1 == LiveCount(); };
+	bool									IsOutside(EdgeRef e) const				{ return OutsideLeft(mesh_, e); };
+	VertRef									AddPoint(T x, T y);
+	void									MarkRemoved(VertRef v);
+	EdgeRef									StartEdge();
+	Location								Locate(const VertType& x, EdgeRef& e);
+	EdgeRef									OpenHullEdge(EdgeRef on);
+	void									FanInside(VertRef v, EdgeRef e);
+	void									FanOutside(VertRef v, EdgeRef h);
+	void									Attach(VertRef v, Location where, EdgeRef e);
+	void									Legalize(VertRef v);
+	bool									ClipEars(bool closed);
+	bool									Unlink(VertRef v);
+
+	// Helpers for moving a Vert; Slide only works when nothing around v turns inside out, then flips until it's Delaunay again
+	bool									Slide(VertRef v, const VertType& to);
+	void									Relax();
+
+	// Number every triangle once, through the dual records, then find all their circumcenters in one go
+	void									BuildFaces();
+	void									BuildCells();
+	void									Changed()								{ facesBuilt_ = false; cellsBuilt_ = false; version_++; };
+
+	// Helpers for the spanning tree
+	std::uint64_t							WeightKey(EdgeRef e) const;
+	void									KruskalMST(EdgeList& mst);
+	void									PrimMST(EdgeList& mst);
+
+	// Helpers for the proximity graphs
+	bool									IsGabriel(EdgeRef e) const;
+	bool									LuneEmpty(EdgeRef e);
 
 public:
 	// Constructors
-	Delaunay(int n);
-	Delaunay(std::vector<std::vector<float>>& buffer);
+	BasicDelaunay(int n);
+	BasicDelaunay(std::vector<std::vector<T>>& buffer);
 
-	// Triangulate the vertices
-	QuadList								GetTriangulation();
-	
-	// Build the Voronoi diagram corresponding to the triangulation
-	QuadList								GetVoronoi();
+	// Takes the points in any order, duplicates and all, and sorts them out in linear time
+	// With morton set, the mesh stores its Verts in Z-order so neighbors in the plane are neighbors in memory;
+	// the triangulation still sees them lexicographically
+	BasicDelaunay(const VertType* points, std::size_t count, bool morton = false);
+	BasicDelaunay(const std::vector<VertType>& points, bool morton = false);
+
+	// Throw away the current graph and start over on a new buffer, keeping the memory we already have
+	void									Reset(std::vector<std::vector<T>>& buffer);
+	void									Reset(const VertType* points, std::size_t count, bool morton = false);
+
+	// The mesh, for anyone who wants to look up where an edge goes
+	const MeshType&							mesh()									{ return mesh_; };
+
+	// Which of the caller's points a Vert came from; the first one wins when there were duplicates
+	std::uint32_t							source(VertRef v) const					{ return sources_[v]; };
+
+	// Whether a Vert has been taken out, either by RemovePoint or for repeating an earlier point
+	bool									removed(VertRef v) const				{ return IsRemoved(v); };
+
+	// Hand us a pool and big triangulations will split their halves across its threads; NULL goes back to one thread
+	// The pool has to outlive any call to GetTriangulation
+	void									setThreadPool(ThreadPool* pool)			{ pool_ = pool; };
+
+	// On by default; turn it off to get plain recursion back
+	void									setExplicitStack(bool on)				{ explicitStack_ = on; };
+
+	// Vertical by default, since that's what we've always done
+	void									setCuts(CutStrategy cuts)				{ cuts_ = cuts; };
+
+	// Triangulate the vertices, if we haven't already
+	// Returns the 0th edge of every live QuadEdge
+	EdgeList								GetTriangulation();
+
+	// Counters and timings from the last build; all zeros unless DELAUNAY_STATS is defined
+	// The counters are shared by everyone in the process, so only measure one triangulation at a time
+	const TriangulationStats&				stats() const							{ return stats_; };
+
+	// Bumped by every build and edit
+	std::uint32_t							version() const							{ return version_; };
 
-	// Build a minimum spanning tree across the vertices
-	EdgeList								GetMST();
+	// Edit the triangulation in place
+	// Both walk from wherever the last edit was, so runs of nearby edits are cheap
+	// Inserting a point that's already there hands back the Vert that's already there
+	// Edits made before the first GetTriangulation just queue up for it
+	VertRef									InsertPoint(T x, T y);
+	bool									RemovePoint(VertRef v);
+
+	// Move a Vert and fix up the triangulation around it, which for a short hop is a handful of edge flips
+	// v keeps its name, so callers can hang on to it while the point wanders
+	// If another Vert is already at (x, y), v gets removed and that one comes back instead
+	VertRef									MovePoint(VertRef v, T x, T y);
+
+	// Every live Vert within radius of v, not counting v, searching outward through the triangulation
+	// Anything that close is connected to v through Verts that are closer still, so only the neighborhood gets looked at
+	void									GetNeighborhood(VertRef v, T radius, PointsList& out);
+
+	// Flatten the triangulation into out in one pass over the Verts, reusing whatever memory out already has
+	// A flat triangulation has no triangles, and its hull runs along the line and back
+	void									Export(TriangulationExport& out);
+
+	// Build the Voronoi diagram corresponding to the triangulation
+	// Returns the dual edge of every QuadEdge with a triangle on both sides; face f is the circumcenter of triangle f
+	// Both are cached, so asking again before the next edit costs nothing
+	EdgeList								GetVoronoi();
+	const VoronoiCells&						GetVoronoiCells();
+
+	// Build a minimum spanning tree across the vertices, by Euclidean length
+	// Every Euclidean MST lives inside the Delaunay triangulation, so we only ever look at its edges
+	// Returns one primal edge per tree edge; a forest if the points somehow aren't connected
+	EdgeList								GetMST(MSTMethod method = KRUSKAL_MST);
+
+	// Sparser graphs than the triangulation that still have loops in them; each one contains the next:
+	// Delaunay, then Gabriel, then relative neighborhood, then the MST
+	// Gabriel keeps an edge if nothing is inside the circle it's the diameter of; only the two corners across from it can be
+	// The relative neighborhood graph keeps an edge if nothing is closer to both of its ends than they are to each other
+	// Both return primal edges and take time linear in the edges, give or take how crowded the neighborhood is
+	EdgeList								GetGabriel();
+	EdgeList								GetRelativeNeighbors();
 };
 
+typedef BasicDelaunay<float>				Delaunay;
+typedef BasicDelaunay<int>					IntDelaunay;
+
 //	--------------------------------------------------------
 //	Constructors
 //	--------------------------------------------------------
 
-Delaunay::Delaunay(int n)
+template <typename T>
+BasicDelaunay<T>::BasicDelaunay() : pool_(NULL), explicitStack_(true), cuts_(VERTICAL_CUTS), version_(0)
+{
+	Clear();
+}
+
+template <typename T>
+BasicDelaunay<T>::BasicDelaunay(int n) : BasicDelaunay()
 {
 	// For the moment, we generate the vertices
-	edges_ = QuadList();
 	GenerateRandomVerts(n);
 }
 
-Delaunay::Delaunay(std::vector<std::vector<float>>& buffer)
+template <typename T>
+BasicDelaunay<T>::BasicDelaunay(std::vector<std::vector<T>>& buffer) : BasicDelaunay()
+{
+	LoadVerts(buffer);
+}
+
+template <typename T>
+BasicDelaunay<T>::BasicDelaunay(const VertType* points, std::size_t count, bool morton) : BasicDelaunay()
+{
+	LoadSpan(points, count, morton);
+}
+
+template <typename T>
+BasicDelaunay<T>::BasicDelaunay(const std::vector<VertType>& points, bool morton) : BasicDelaunay()
+{
+	LoadSpan(points.data(), points.size(), morton);
+}
+
+template <typename T>
+void BasicDelaunay<T>::Clear()
+{
+	// Everything we handed out is dead now, but the arrays keep their capacity for the next generation
+	mesh_.Reset();
+	vertices_.clear();
+	sources_.clear();
+	removed_.clear();
+	removedCount_ = 0;
+	built_ = false;
+	sorted_ = true;
+	lastEdge_ = NIL;
+	facesBuilt_ = false;
+	cellsBuilt_ = false;
+	stats_ = TriangulationStats();
+}
+
+template <typename T>
+void BasicDelaunay<T>::Reset(std::vector<std::vector<T>>& buffer)
+{
+	Clear();
+	Changed();
+	LoadVerts(buffer);
+}
+
+template <typename T>
+void BasicDelaunay<T>::Reset(const VertType* points, std::size_t count, bool morton)
 {
-	edges_ = QuadList();
+	Clear();
+	Changed();
+	LoadSpan(points, count, morton);
+}
+
+template <typename T>
+void BasicDelaunay<T>::LoadVerts(std::vector<std::vector<T>>& buffer)
+{
+	// A planar triangulation has fewer than three edges per point
+	mesh_.Reserve(buffer.size(), buffer.size() * 3);
 
 	// Turn it into Verts for the convenience of our algorithm
 	for (int i = 0; i < buffer.size(); i++)
 	{
-		vertices_.push_back(new Vert(buffer[i][0], buffer[i][1]));
+		vertices_.push_back(mesh_.AddVert(buffer[i][0], buffer[i][1]));
+		sources_.push_back(i);
+	}
+}
+
+template <typename T>
+void BasicDelaunay<T>::LoadSpan(const VertType* points, std::size_t count, bool morton)
+{
+	// Sort on (x, y) as one 64-bit key; equal keys mean equal points, so deduping is just skipping repeats
+#ifdef DELAUNAY_STATS
+	double start = StatsClock();
+#endif
+	sortItems_.resize(count);
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		sortItems_[i].key = LexKey(OrderedBits(points[i].x()), OrderedBits(points[i].y()));
+		sortItems_[i].index = i;
+	}
+
+	RadixSort(sortItems_, sortScratch_);
+
+	// It's stable, so the first copy of a duplicate is the one from earliest in the caller's array
+	std::size_t unique = 0;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		if (i == 0 || sortItems_[i].key != sortItems_[unique - 1].key)
+		{
+			sortItems_[unique++] = sortItems_[i];
+		}
+	}
+	sortItems_.resize(unique);
+
+	// A planar triangulation has fewer than three edges per point
+	mesh_.Reserve(unique, unique * 3);
+	vertices_.resize(unique);
+	sources_.reserve(unique);
+
+	if (!morton)
+	{
+		// Store them in the order we'll triangulate them
+		for (std::size_t i = 0; i < unique; i++)
+		{
+			const VertType& p = points[sortItems_[i].index];
+			vertices_[i] = mesh_.AddVert(p.x(), p.y());
+			sources_.push_back(sortItems_[i].index);
+		}
+	}
+	else
+	{
+		// Re-key the survivors by Z-order and tag them with their lexicographic rank
+		// vertices_ holds on to where each rank came from until we know which Vert it turns into
+		for (std::size_t i = 0; i < unique; i++)
+		{
+			const VertType& p = points[sortItems_[i].index];
+			vertices_[i] = sortItems_[i].index;
+			sortItems_[i].key = MortonKey(OrderedBits(p.x()), OrderedBits(p.y()));
+			sortItems_[i].index = i;
+		}
+
+		RadixSort(sortItems_, sortScratch_);
+
+		// Store them in Z-order and point each rank at where its Vert ended up
+		for (std::size_t i = 0; i < unique; i++)
+		{
+			std::uint32_t rank = sortItems_[i].index;
+			std::uint32_t source = vertices_[rank];
+			vertices_[rank] = mesh_.AddVert(points[source].x(), points[source].y());
+			sources_.push_back(source);
+		}
 	}
+
+#ifdef DELAUNAY_STATS
+	stats_.sortMs = StatsClock() - start;
+#endif
 }
 
-void Delaunay::GenerateRandomVerts(int n)
+template <typename T>
+void BasicDelaunay<T>::GenerateRandomVerts(int n)
 {
 	// Generate a field of random vertices for debug/demonstration
 
 	srand(time(NULL));
 
-	std::vector<std::vector<int>> buffer;
+	std::vector<VertType> buffer;
+	buffer.reserve(n);
 
 	// Build a buffer list
 	for (int i = 0; i < n; i++)
 	{
-		std::vector<int> xy = { rand() % 512, rand() % 512 };
-		buffer.push_back(xy);
+		buffer.push_back(VertType((T)(rand() % 512), (T)(rand() % 512)));
 	}
 
-	// Sort it lexicographically; we need this step
-	std::sort(buffer.begin(), buffer.end());
-	buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
-
-	// Turn it into Verts for the convenience of our algorithm
-	for (int i = 0; i < buffer.size(); i++)
-	{
-		vertices_.push_back(new Vert(buffer[i][0], buffer[i][1]));
-	}
+	// LoadSpan does the sorting and deduping for us
+	LoadSpan(buffer.data(), buffer.size(), false);
 }
 
 //	--------------------------------------------------------
 //	Functions for managing the QuadEdges
 //	--------------------------------------------------------
 
-void Delaunay::Kill(Edge* edge)
+template <typename T>
+void BasicDelaunay<T>::Kill(EdgeRef edge, EdgeArena& arena)
 {
-	// Fix the local mesh
-	Splice(edge, edge->Oprev());
-	Splice(edge->Sym(), edge->Sym()->Oprev());
-
-	// Free the quad edge that the edge belongs to
-	QuadEdge* raw = (QuadEdge*)(edge - (edge->index()));
-	edges_.erase(std::remove(edges_.begin(), edges_.end(), raw));
-	delete raw;
+	// Fix the local mesh and hand the quad edge back to the free list
+	mesh_.DeleteEdge(arena, edge);
 }
 
 //	--------------------------------------------------------
 //	Helper functions
 //	--------------------------------------------------------
 
-// Split the list of vertices in the center
-// This relies on the assumption that they're ordered lexicographically
-PointsPartition Delaunay::SplitPoints(const PointsList& points)
+// Creates an edge between the given vertices
+// This is accomplished by creating a new QuadEdge, setting its 0th edge to originate at a and setting its 2nd edge to originate at b
+template <typename T>
+EdgeRef BasicDelaunay<T>::MakeEdgeBetween(VertRef a, VertRef b, EdgeArena& arena)
 {
-	int halfway = (points.size() / 2);
-
-	PointsList left(points.begin(), points.begin() + halfway);
-	PointsList right(points.begin() + halfway, points.end());
-
-	return PointsPartition(left, right);
-}
+	// Create the QuadEdge and return the index of its 0th edge
+	EdgeRef e = mesh_.MakeEdge(arena);
 
-// Creates an edge between the vertices at the given indices
-// This is accomplished by creating a new QuadEdge, setting its 0th edge to originate at points[a] and setting its 2nd edge to originate at points[b]
-Edge* Delaunay::MakeEdgeBetween(int a, int b, const PointsList& points)
-{
-	// Create the QuadEdge and return the memory address of its 0th edge
-	Edge* e = Edge::Make(edges_);
-	
-	// Set it to originate from the Vert at index a
-	e->setOrigin(points[a]);
+	// Set it to originate from a
+	mesh_.setOrigin(e, a);
 
-	// Set its twin to originate from the Vert at index b
-	Vert* points_b = points[b];
-	e->setDestination(points_b);
+	// Set its twin to originate from b
+	mesh_.setDestination(e, b);
 
-	// Return a pointer to our new edge
+	// Return our new edge
 	return e;
 }
 
 // Connects the ends of two edges to form a coherently oriented triangle
-Edge* Delaunay::Connect(Edge* a, Edge* b)
+template <typename T>
+EdgeRef BasicDelaunay<T>::Connect(EdgeRef a, EdgeRef b, EdgeArena& arena)
 {
 	// See Guibas and Stolfi for more
 
-	// Create a new QuadEdge and return the memory address of its 0th edge
-	Edge* e = Edge::Make(edges_);
+	// Create a new QuadEdge and return the index of its 0th edge
+	EdgeRef e = mesh_.MakeEdge(arena);
 
 	// Set it to originate at the end point of b
-	e->setOrigin(a->destination());
+	mesh_.setOrigin(e, mesh_.Dest(a));
 
 	// Set it to end at the beginning of a, thus giving it a coherent orientation
-	e->setDestination(b->origin());
+	mesh_.setDestination(e, mesh_.Org(b));
 
 	// Perform splice operations -- I'm still not quite sure why
-	Splice(e, a->Lnext());
-	Splice(e->Sym(), b);
+	mesh_.Splice(e, mesh_.Lnext(a));
+	mesh_.Splice(Sym(e), b);
 
-	// Return a pointer to our new edge
+	// Return our new edge
 	return e;
 }
 
 // Connects two vertices into an edge
-EdgePartition Delaunay::LinePrimitive(const PointsList& points)
+template <typename T>
+EdgePartition BasicDelaunay<T>::LinePrimitive(std::uint32_t lo, EdgeArena& arena)
 {
 	// Build a line primitive
 	// And return it twice?
-	Edge* e = MakeEdgeBetween(0, 1, points);
-	Edge* e_sym = e->Sym();
-	return EdgePartition({ e }, { e_sym });
+	EdgeRef e = MakeEdgeBetween(vertices_[lo], vertices_[lo + 1], arena);
+	EdgeRef e_sym = Sym(e);
+	return EdgePartition(e, e_sym);
 }
 
 // Connects three vertices into a coherently oriented triangle
-EdgePartition Delaunay::TrianglePrimitive(const PointsList& points)
+template <typename T>
+EdgePartition BasicDelaunay<T>::TrianglePrimitive(std::uint32_t lo, EdgeArena& arena)
 {
 	// Build our first two edges here
-	Edge* a = MakeEdgeBetween(0, 1, points);
-	Edge* b = MakeEdgeBetween(1, 2, points);
+	EdgeRef a = MakeEdgeBetween(vertices_[lo], vertices_[lo + 1], arena);
+	EdgeRef b = MakeEdgeBetween(vertices_[lo + 1], vertices_[lo + 2], arena);
 
 	// Do the splice thing; I'm not sure why
-	Splice(a->Sym(), b);
+	mesh_.Splice(Sym(a), b);
+
+	const VertType& p0 = mesh_.vert(vertices_[lo]);
+	const VertType& p1 = mesh_.vert(vertices_[lo + 1]);
+	const VertType& p2 = mesh_.vert(vertices_[lo + 2]);
 
 	// We want a consistent face orientation, so determine which way we're going here
-	if (CCW(points[0], points[1], points[2]))
+	if (CCW(p0, p1, p2))
 	{
-		Edge* c = Connect(b, a);
-		return EdgePartition({ a }, { b->Sym() });
+		EdgeRef c = Connect(b, a, arena);
+		return EdgePartition(a, Sym(b));
 	}
-	else if (CCW(points[0], points[2], points[1]))
+	else if (CCW(p0, p2, p1))
 	{
-		Edge* c = Connect(b, a);
-		return EdgePartition({ c->Sym() }, { c });
+		EdgeRef c = Connect(b, a, arena);
+		return EdgePartition(Sym(c), c);
 	}
 	else
 	{
 		// The points are collinear
-		return EdgePartition({ a }, { b->Sym() });
+		return EdgePartition(a, Sym(b));
+	}
+}
+
+template <typename T>
+EdgePartition BasicDelaunay<T>::Primitive(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena)
+{
+	// The primitives need their points in order, and median cuts only promise which side of the cut they're on
+	if (cuts_ == ALTERNATING_CUTS)
+	{
+		std::sort(vertices_.begin() + lo, vertices_.begin() + hi, [this, axis](VertRef a, VertRef b) { return KeyLess(a, b, axis); });
+	}
+
+	return (hi - lo == 2) ? LinePrimitive(lo, arena) : TrianglePrimitive(lo, arena);
+}
+
+//	--------------------------------------------------------
+//	Cutting
+//	--------------------------------------------------------
+
+template <typename T>
+bool BasicDelaunay<T>::KeyLess(VertRef a, VertRef b, int axis) const
+{
+	const VertType& p = mesh_.vert(a);
+	const VertType& q = mesh_.vert(b);
+
+	if (axis == 0)
+	{
+		return LexLess(p, q);
+	}
+	else
+	{
+		return (p.y() < q.y()) || (p.y() == q.y() && p.x() > q.x());
+	}
+}
+
+template <typename T>
+std::uint32_t BasicDelaunay<T>::Split(std::uint32_t lo, std::uint32_t hi, int axis)
+{
+	// Both halves get at least two points, since we have at least four
+	std::uint32_t mid = lo + (hi - lo) / 2;
+
+	// The vertical cut can trust the sort we did up front; anything else has to find its own median
+	if (cuts_ == ALTERNATING_CUTS)
+	{
+		std::nth_element(vertices_.begin() + lo, vertices_.begin() + mid, vertices_.begin() + hi, [this, axis](VertRef a, VertRef b) { return KeyLess(a, b, axis); });
 	}
+
+	return mid;
+}
+
+template <typename T>
+EdgePartition BasicDelaunay<T>::Reframe(EdgePartition hull, int axis) const
+{
+	// A half that was cut the other way hands back its extreme edges for the wrong axis
+	// So walk its whole hull and find the ones for this axis instead
+	// second has the outside on its left, so Lnext takes us around the hull with an edge leaving every hull vertex
+	EdgeRef start = hull.second;
+	EdgeRef lowest = start;
+	EdgeRef highest = start;
+
+	EdgeRef e = start;
+	do
+	{
+		if (KeyLess(mesh_.Org(e), mesh_.Org(lowest), axis))
+		{
+			lowest = e;
+		}
+		if (KeyLess(mesh_.Org(highest), mesh_.Org(e), axis))
+		{
+			highest = e;
+		}
+		e = mesh_.Lnext(e);
+	} while (e != start);
+
+	// Out of the lowest vertex we want the edge with the inside on its left, which is the one coming in, turned around
+	return EdgePartition(Sym(mesh_.Lprev(lowest)), highest);
 }
 
-Edge* Delaunay::LowestCommonTangent(Edge*& left_inner, Edge*& right_inner)
+template <typename T>
+EdgeRef BasicDelaunay<T>::LowestCommonTangent(EdgeRef& left_inner, EdgeRef& right_inner, EdgeArena& arena)
 {
 	// Compute the lower common tangent of the two halves
-	// Note the pointer references; we want to keep track of where the new inner edges end up
+	// Note the references; we want to keep track of where the new inner edges end up
 
 	// Until we can't do it anymore, take turns rotating along the hulls of the two shapes we're connecting
 	while (true)
 	{
-		if (LeftOf(left_inner, right_inner->origin()))
+		DELAUNAY_COUNT_LEVEL(tangentSteps);
+
+		if (LeftOf(mesh_, left_inner, mesh_.origin(right_inner)))
 		{
-			left_inner = left_inner->Lnext();
+			left_inner = mesh_.Lnext(left_inner);
 		}
-		else if (RightOf(right_inner, left_inner->origin()))
+		else if (RightOf(mesh_, right_inner, mesh_.origin(left_inner)))
 		{
-			right_inner = right_inner->Rprev();
+			right_inner = mesh_.Rprev(right_inner);
 		}
 		else
 		{
@@ -266,21 +713,22 @@ Edge* Delaunay::LowestCommonTangent(Edge*& left_inner, Edge*& right_inner)
 	}
 
 	// Create the base edge once we hit the bottom
-	Edge* base_edge = Connect(right_inner->Sym(), left_inner);
+	EdgeRef base_edge = Connect(Sym(right_inner), left_inner, arena);
 	return base_edge;
 }
 
-Edge* Delaunay::LeftCandidate(Edge* base_edge)
+template <typename T>
+EdgeRef BasicDelaunay<T>::LeftCandidate(EdgeRef base_edge, EdgeArena& arena)
 {
 	// Picks out a "candidate" edge from the left half of the domain
-	Edge* left_candidate = base_edge->Sym()->Onext();
+	EdgeRef left_candidate = mesh_.Onext(Sym(base_edge));
 
-	if (Valid(left_candidate, base_edge))
+	if (Valid(mesh_, left_candidate, base_edge))
 	{
-		while (InCircle(base_edge->destination(), base_edge->origin(), left_candidate->destination(), left_candidate->Onext()->destination()))
+		while (InCircle(mesh_.destination(base_edge), mesh_.origin(base_edge), mesh_.destination(left_candidate), mesh_.destination(mesh_.Onext(left_candidate))))
 		{
-			Edge* t = left_candidate->Onext();
-			Kill(left_candidate);
+			EdgeRef t = mesh_.Onext(left_candidate);
+			Kill(left_candidate, arena);
 			left_candidate = t;
 		}
 	}
@@ -288,17 +736,18 @@ Edge* Delaunay::LeftCandidate(Edge* base_edge)
 	return left_candidate;
 }
 
-Edge* Delaunay::RightCandidate(Edge* base_edge)
+template <typename T>
+EdgeRef BasicDelaunay<T>::RightCandidate(EdgeRef base_edge, EdgeArena& arena)
 {
 	// Picks out a "candidate" edge from the right half of the domain
-	Edge* right_candidate = base_edge->Oprev();
+	EdgeRef right_candidate = mesh_.Oprev(base_edge);
 
-	if (Valid(right_candidate, base_edge))
+	if (Valid(mesh_, right_candidate, base_edge))
 	{
-		while (InCircle(base_edge->destination(), base_edge->origin(), right_candidate->destination(), right_candidate->Oprev()->destination()))
+		while (InCircle(mesh_.destination(base_edge), mesh_.origin(base_edge), mesh_.destination(right_candidate), mesh_.destination(mesh_.Oprev(right_candidate))))
 		{
-			Edge* t = right_candidate->Oprev();
-			Kill(right_candidate);
+			EdgeRef t = mesh_.Oprev(right_candidate);
+			Kill(right_candidate, arena);
 			right_candidate = t;
 		}
 	}
@@ -306,161 +755,1411 @@ Edge* Delaunay::RightCandidate(Edge* base_edge)
 	return right_candidate;
 }
 
-void Delaunay::MergeHulls(Edge*& base_edge)
+template <typename T>
+void BasicDelaunay<T>::MergeHulls(EdgeRef& base_edge, EdgeArena& arena)
 {
 	// Zip up the two halves of the hull once we've found the base edge
 	while (true)
 	{
+		DELAUNAY_COUNT_LEVEL(mergeSteps);
+
 		// Get our candidate edges (really becaue we care about their vertices)
-		Edge* left_candidate = LeftCandidate(base_edge);
-		Edge* right_candidate = RightCandidate(base_edge);
+		EdgeRef left_candidate = LeftCandidate(base_edge, arena);
+		EdgeRef right_candidate = RightCandidate(base_edge, arena);
 
-		if (!Valid(left_candidate, base_edge) && !Valid(right_candidate, base_edge))
+		if (!Valid(mesh_, left_candidate, base_edge) && !Valid(mesh_, right_candidate, base_edge))
 		{
 			// If neither is valid, we have nothing more to do because we've reached the top
 			break;
 		}
-		else if (	!Valid(left_candidate, base_edge) ||
-					InCircle(left_candidate->destination(), left_candidate->origin(), right_candidate->origin(), right_candidate->destination()))
+		else if (	!Valid(mesh_, left_candidate, base_edge) ||
+					InCircle(mesh_.destination(left_candidate), mesh_.origin(left_candidate), mesh_.origin(right_candidate), mesh_.destination(right_candidate)))
 		{
 			// Otherwise, if we can rule out the left guy, connect the right edge to the base and set the new base edge
 			// This ruling out comes either from creating an invalid hypothetical triangle or from being beneath the base edge
-			base_edge = Connect(right_candidate, base_edge->Sym());
+			base_edge = Connect(right_candidate, Sym(base_edge), arena);
 		}
 		else
 		{
 			// If we can't do that, then the left edge must be valid and we connect it to the base and set the new base edge
-			base_edge = Connect(base_edge->Sym(), left_candidate->Sym());
+			base_edge = Connect(Sym(base_edge), Sym(left_candidate), arena);
 		}
 	}
 }
 
+template <typename T>
+EdgePartition BasicDelaunay<T>::Merge(EdgePartition left, EdgePartition right, int axis, EdgeArena& arena)
+{
+	// Stitches two triangulated halves together, given the outer edges each of them handed back
+	DELAUNAY_COUNT_LEVEL(merges);
+
+	// With alternating cuts, the halves were cut across the other axis
+	// Expected hulls are small, so walking them is cheap next to the merge we save
+	if (cuts_ == ALTERNATING_CUTS)
+	{
+		left = Reframe(left, axis);
+		right = Reframe(right, axis);
+	}
+
+	// Get the inner "inner" edges
+	EdgeRef right_inner = right.first;
+	EdgeRef left_inner = left.second;
+
+	// Get the initial "outer" edges
+	EdgeRef left_outer = left.first;
+	EdgeRef right_outer = right.second;
+
+	// Get the lowest common tangent from our initial inner edges
+	EdgeRef base_edge = LowestCommonTangent(left_inner, right_inner, arena);
+
+	// Correct the base edge
+	if (mesh_.Org(left_inner) == mesh_.Org(left_outer))
+	{
+		left_outer = Sym(base_edge);
+	}
+	if (mesh_.Org(right_inner) == mesh_.Org(right_outer))
+	{
+		right_outer = base_edge;
+	}
+
+	// Finish the merge operation by "zipping up the gap"
+	// i.e. connect things if they don't violate the Delaunay criterion
+	MergeHulls(base_edge, arena);
+
+	// Return the outer edges, because they'll be the new inner edges when we do a higher-level merge
+	return EdgePartition(left_outer, right_outer);
+}
+
 //	--------------------------------------------------------
 //	The main attraction
 //	--------------------------------------------------------
 
-EdgePartition Delaunay::Triangulate(const PointsList& points)
+template <typename T>
+EdgePartition BasicDelaunay<T>::Triangulate(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena)
 {
 	// Returns the left and right hulls created by triangulating
-	// The ultimate value we care about is actually the edges_ member of the Delaunay class
+	// The ultimate value we care about is actually the mesh_ member of the Delaunay class
 	// This is recursive because divide-and-conquer is a good way to do this
 	// See Guibas and Stolfi
 
 	// (Also, we have to assume that the point set we're given is sorted lexicographically)
+	// (Unless we're alternating cuts, in which case we find medians as we go)
 
 	/* Terminal cases */
-	
-	if (points.size() == 2)
+
+	if (hi - lo <= 3)
 	{
-		return LinePrimitive(points);
+		return Primitive(lo, hi, axis, arena);
 	}
-	if (points.size() == 3)
+
+	bool fork = (pool_ != NULL && hi - lo >= PARALLEL_CUTOFF);
+
+	// Nothing left to fork, so let the loop take it from here
+	if (!fork && explicitStack_)
 	{
-		return TrianglePrimitive(points);
+		return TriangulateIterative(lo, hi, axis, arena);
 	}
 
 	// Once we survive the terminal-case filter, split up the points
-	PointsPartition partition = SplitPoints(points);
+	std::uint32_t mid = Split(lo, hi, axis);
+	int child = ChildAxis(axis);
 
-	EdgePartition left = Triangulate(std::get<0>(partition));
-	EdgePartition right = Triangulate(std::get<1>(partition));
+	EdgePartition left;
+	EdgePartition right;
 
-	/* This part of the code is only reachable once we terminate, at which point the vectors are singleton sets */
-	
-	// Get the inner "inner" edges
-	Edge* right_inner = std::get<0>(right)[0];
-	Edge* left_inner = std::get<1>(left)[0];
+	if (fork)
+	{
+		// Big enough to be worth forking
+		// Each half gets a run of records of its own, four QuadEdges per point, which is more than it can ever have alive at once
+		// Since the runs don't overlap and the array never grows, the halves can't step on each other
+		EdgeArena left_arena = mesh_.Carve(arena, (mid - lo) * 4);
+		EdgeArena right_arena = mesh_.Carve(arena, (hi - mid) * 4);
 
-	// Get the initial "outer" edges
-	Edge* left_outer = std::get<0>(left)[0];
-	Edge* right_outer = std::get<1>(right)[0];
+		PoolTask task([&]() { left = Triangulate(lo, mid, child, left_arena); });
+		pool_->Submit(&task);
 
-	// Get the lowest common tangent from our initial inner edges
-	Edge* base_edge = LowestCommonTangent(left_inner, right_inner);
+		right = Triangulate(mid, hi, child, right_arena);
+		pool_->Wait(&task);
 
-	// Correct the base edge
-	if (left_inner->origin() == left_outer->origin())
+		// Take back what they didn't use; the merge below will want it
+		mesh_.Return(arena, left_arena);
+		mesh_.Return(arena, right_arena);
+	}
+	else
 	{
-		left_outer = base_edge->Sym();
+		left = Triangulate(lo, mid, child, arena);
+		right = Triangulate(mid, hi, child, arena);
 	}
-	if (right_inner->origin() == right_outer->origin())
+
+	DELAUNAY_SET_LEVEL(hi - lo);
+	return Merge(left, right, axis, arena);
+}
+
+template <typename T>
+EdgePartition BasicDelaunay<T>::TriangulateIterative(std::uint32_t lo, std::uint32_t hi, int axis, EdgeArena& arena)
+{
+	// Same recursion as above, but the frames live in a fixed array, so there's no heap and no chance of running off the stack
+	// Each frame goes through three stages: split and descend left, take the left result and descend right, then merge
+	struct Frame
 	{
-		right_outer = base_edge;
+		std::uint32_t						lo;
+		std::uint32_t						mid;
+		std::uint32_t						hi;
+		int									axis;
+		int									stage;
+		EdgePartition						left;
+	};
+
+	Frame stack[TRIANGULATE_MAX_DEPTH];
+	int top = 0;
+
+	// Whatever the last frame we finished handed back
+	EdgePartition result;
+
+	stack[top].lo = lo;
+	stack[top].hi = hi;
+	stack[top].axis = axis;
+	stack[top].stage = 0;
+	top++;
+
+	while (top > 0)
+	{
+		Frame& f = stack[top - 1];
+
+		if (f.stage == 0 && f.hi - f.lo <= 3)
+		{
+			// A leaf; build it and pop
+			result = Primitive(f.lo, f.hi, f.axis, arena);
+			top--;
+		}
+		else if (f.stage == 0)
+		{
+			// Split and go left
+			f.mid = Split(f.lo, f.hi, f.axis);
+			f.stage = 1;
+
+			stack[top].lo = f.lo;
+			stack[top].hi = f.mid;
+			stack[top].axis = ChildAxis(f.axis);
+			stack[top].stage = 0;
+			top++;
+		}
+		else if (f.stage == 1)
+		{
+			// The left half just finished; hang onto it and go right
+			f.left = result;
+			f.stage = 2;
+
+			stack[top].lo = f.mid;
+			stack[top].hi = f.hi;
+			stack[top].axis = ChildAxis(f.axis);
+			stack[top].stage = 0;
+			top++;
+		}
+		else
+		{
+			// Both halves are done
+			DELAUNAY_SET_LEVEL(f.hi - f.lo);
+			result = Merge(f.left, result, f.axis, arena);
+			top--;
+		}
 	}
 
-	// Finish the merge operation by "zipping up the gap"
-	// i.e. connect things if they don't violate the Delaunay criterion
-	MergeHulls(base_edge);
+	return result;
+}
 
-	// Return the outer edges, because they'll be the new inner edges when we do a higher-level merge
-	return EdgePartition({ left_outer }, { right_outer });
+template <typename T>
+void BasicDelaunay<T>::Build()
+{
+#ifdef DELAUNAY_STATS
+	ResetCounters();
+	double start = StatsClock();
+#endif
+
+	// Sweep out anything that was removed before we got here
+	if (removedCount_ > 0)
+	{
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < vertices_.size(); i++)
+		{
+			if (!IsRemoved(vertices_[i]))
+			{
+				vertices_[kept++] = vertices_[i];
+			}
+		}
+		vertices_.resize(kept);
+		removedCount_ = 0;
+	}
+
+	// Points inserted before the first build went on the end, so put them in their place and weed out repeats
+	if (!sorted_)
+	{
+		std::sort(vertices_.begin(), vertices_.end(), [this](VertRef a, VertRef b) { return KeyLess(a, b, 0); });
+
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < vertices_.size(); i++)
+		{
+			if (kept > 0 && !KeyLess(vertices_[kept - 1], vertices_[i], 0))
+			{
+				removed_.resize(mesh_.vertCount(), false);
+				removed_[vertices_[i]] = true;
+				continue;
+			}
+			vertices_[kept++] = vertices_[i];
+		}
+		vertices_.resize(kept);
+		sorted_ = true;
+	}
+
+	std::uint32_t n = vertices_.size();
+
+	if (n < 2)
+	{
+		// Nothing to connect
+	}
+	else if (pool_ != NULL)
+	{
+		// Lay out every record the recursion could want up front, so no thread ever sees the array move
+		std::uint32_t budget = n * 4 + 4;
+		mesh_.Presize(budget);
+
+		EdgeArena root = mesh_.Carve(mesh_.arena(), budget);
+		Triangulate(0, n, 0, root);
+		mesh_.Return(mesh_.arena(), root);
+	}
+	else
+	{
+		Triangulate(0, n, 0, mesh_.arena());
+	}
+
+#ifdef DELAUNAY_STATS
+	ReadCounters(stats_);
+	stats_.triangulateMs = StatsClock() - start;
+#endif
+
+	built_ = true;
+	lastEdge_ = NIL;
+	Changed();
 }
 
-QuadList Delaunay::GetTriangulation()
+template <typename T>
+void BasicDelaunay<T>::Rebuild()
 {
-	// Wrapper for the triangulation function
-	// This should make it less confusing to call Triangulate with the right vertex list
-	EdgePartition tuple = Triangulate(vertices_);
-	return edges_;
+	mesh_.ClearEdges();
+	Build();
 }
 
-QuadList Delaunay::GetVoronoi()
+template <typename T>
+EdgeList BasicDelaunay<T>::GetTriangulation()
 {
-	for (auto i = edges_.begin(); i != edges_.end(); i++)
+	// Wrapper for the triangulation function
+	// This should make it less confusing to call Triangulate with the right vertex list
+	if (!built_)
 	{
-		Edge* e = (*i)->edges;
+		Build();
+	}
+
+	// Hand back the 0th edge of everything that survived
+	EdgeList edges;
+	edges.reserve(mesh_.quadCount());
 
-		// If we're not on the exterior
-		if (CCW(e[0].origin(), e[0].destination(), e[0].Onext()->destination())
-			&& CCW(e[0].origin(), e[0].Oprev()->destination(), e[0].destination()))
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q))
 		{
-			e[1].setOrigin(Circumcenter(e[0].origin(), e[0].destination(), e[0].Onext()->destination()));
-			e[3].setOrigin(Circumcenter(e[0].origin(), e[0].Oprev()->destination(), e[0].destination()));
+			edges.push_back(q * 4);
 		}
 	}
 
-	return edges_;
+	return edges;
 }
 
-EdgeList Delaunay::GetMST()
+//	--------------------------------------------------------
+//	Editing
+//	--------------------------------------------------------
+
+template <typename T>
+VertRef BasicDelaunay<T>::AddPoint(T x, T y)
 {
-	// Okay, so we're not weighting it right now
-	// I can't really think of a reason to
-	EdgeList mst;
-	PointsList queue;
-	std::map<Vert*, int> distance;
+	VertRef v = mesh_.AddVert(x, y);
+	vertices_.push_back(v);
+	sources_.push_back(NIL);
+	return v;
+}
 
-	for (auto i = vertices_.begin(); i != vertices_.end(); i++)
+template <typename T>
+void BasicDelaunay<T>::MarkRemoved(VertRef v)
+{
+	if (removed_.size() < mesh_.vertCount())
 	{
-		distance[*i] = -1;
+		removed_.resize(mesh_.vertCount(), false);
 	}
 
-	// So we just do a depth-first search on the linked list
-	Vert* root = vertices_[0];
-	queue.push_back(root);
-	distance[root] = 0;
+	removed_[v] = true;
+	removedCount_++;
+}
 
-	while (queue.size() > 0)
+template <typename T>
+EdgeRef BasicDelaunay<T>::StartEdge()
+{
+	// The last edit's edge is usually still there; if it's been freed, any edge will do
+	if (lastEdge_ != NIL && mesh_.IsLive(Quad(lastEdge_)))
 	{
-		Vert* current = queue.back();
-		queue.pop_back();
+		return lastEdge_;
+	}
 
-		// Check out my syntax skills
-		for (Edge* e = current->edge(); e != current->edge()->Oprev(); e = e->Onext())
+	for (std::size_t i = 0; i < vertices_.size(); i++)
+	{
+		if (mesh_.edge(vertices_[i]) != NIL)
 		{
-			Vert* dest = e->destination();
-			if (distance[dest] == -1)
-			{
-				distance[dest] = distance[current] + 1;
-				queue.push_back(dest);
-				mst.push_back(e);
-			}
+			lastEdge_ = mesh_.edge(vertices_[i]);
+			return lastEdge_;
 		}
-	} 
+	}
 
-	return mst;
+	return NIL;
+}
+
+template <typename T>
+Location BasicDelaunay<T>::Locate(const VertType& x, EdgeRef& e)
+{
+	e = StartEdge();
+	return WalkTo(mesh_, x, e);
+}
+
+template <typename T>
+EdgeRef BasicDelaunay<T>::OpenHullEdge(EdgeRef on)
+{
+	// The new point is on a hull edge (with its triangle on the left), so that edge has to go
+	// Then the other two sides of its triangle are hull edges that the point is strictly outside of
+	EdgeRef h = mesh_.Lnext(on);
+	Kill(on, mesh_.arena());
+	return h;
+}
+
+template <typename T>
+void BasicDelaunay<T>::FanInside(VertRef v, EdgeRef e)
+{
+	// Connect v to every corner of the face left of e; see Guibas and Stolfi's InsertSite
+	EdgeArena& arena = mesh_.arena();
+
+	EdgeRef base = MakeEdgeBetween(mesh_.Org(e), v, arena);
+	mesh_.Splice(base, e);
+	EdgeRef start = base;
+
+	do
+	{
+		suspects_.push_back(e);
+		base = Connect(e, Sym(base), arena);
+		e = mesh_.Oprev(base);
+	} while (mesh_.Lnext(e) != start);
+
+	suspects_.push_back(e);
+}
+
+template <typename T>
+void BasicDelaunay<T>::FanOutside(VertRef v, EdgeRef h)
+{
+	// Connect v to every hull Vert it can see, which is a run of hull edges that v is strictly left of
+	// h is one of them; back up to the first
+	EdgeArena& arena = mesh_.arena();
+	const VertType& x = mesh_.vert(v);
+
+	while (LeftOf(mesh_, mesh_.Lprev(h), x))
+	{
+		h = mesh_.Lprev(h);
+	}
+
+	// The first spoke goes in the outside wedge right after h, then every Connect closes off one more triangle
+	EdgeRef base = MakeEdgeBetween(mesh_.Org(h), v, arena);
+	mesh_.Splice(base, h);
+
+	EdgeRef e = h;
+	do
+	{
+		suspects_.push_back(e);
+		base = Connect(e, Sym(base), arena);
+		e = mesh_.Oprev(base);
+	} while (LeftOf(mesh_, e, x));
+}
+
+template <typename T>
+void BasicDelaunay<T>::Legalize(VertRef v)
+{
+	// Every suspect is opposite v in one of its new triangles, with v on its left
+	// If v is inside the circle through the triangle on the other side, flip, and the far triangle's edges become suspects
+	const VertType& x = mesh_.vert(v);
+
+	while (!suspects_.empty())
+	{
+		EdgeRef e = suspects_.back();
+		suspects_.pop_back();
+
+		EdgeRef t = mesh_.Oprev(e);
+
+		if (RightOf(mesh_, e, mesh_.destination(t)) && InCircle(mesh_.origin(e), mesh_.destination(t), mesh_.destination(e), x))
+		{
+			EdgeRef far_side = mesh_.Lnext(t);
+			mesh_.Swap(e);
+			suspects_.push_back(t);
+			suspects_.push_back(far_side);
+		}
+	}
+}
+
+template <typename T>
+bool BasicDelaunay<T>::ClipEars(bool closed)
+{
+	// boundary_ holds the edges around the hole left by a removed Vert, in order, each with the hole on its left
+	// A closed hole gets filled completely; an open one (the Vert was on the hull) gets filled until what's left is convex
+	// We clip any ear whose circumcircle has none of the other boundary Verts in it, which makes it a Delaunay triangle (Devillers)
+	EdgeArena& arena = mesh_.arena();
+
+	while (true)
+	{
+		std::size_t m = boundary_.size();
+
+		if ((closed && m <= 3) || (!closed && m <= 1))
+		{
+			return true;
+		}
+
+		bool clipped = false;
+
+		for (std::size_t j = (closed ? 0 : 1); j < m && !clipped; j++)
+		{
+			// The ear at the Vert between in and out
+			std::size_t i = (j + m - 1) % m;
+			EdgeRef in = boundary_[i];
+			EdgeRef out = boundary_[j];
+
+			const VertType& a = mesh_.origin(in);
+			const VertType& b = mesh_.origin(out);
+			const VertType& c = mesh_.destination(out);
+
+			if (!CCW(a, b, c))
+			{
+				continue;
+			}
+
+			bool empty = true;
+
+			for (std::size_t k = 0; k < m && empty; k++)
+			{
+				VertRef q = mesh_.Org(boundary_[k]);
+				if (q != mesh_.Org(in) && q != mesh_.Org(out) && q != mesh_.Dest(out) && InCircle(a, b, c, mesh_.vert(q)))
+				{
+					empty = false;
+				}
+			}
+
+			// An open chain has one more Vert hanging off its last edge
+			if (!closed && empty)
+			{
+				VertRef q = mesh_.Dest(boundary_[m - 1]);
+				if (q != mesh_.Dest(out) && InCircle(a, b, c, mesh_.vert(q)))
+				{
+					empty = false;
+				}
+			}
+
+			if (empty)
+			{
+				// Cut the ear off; the hole keeps the diagonal, facing the same way as the rest
+				EdgeRef diagonal = Connect(out, in, arena);
+				boundary_[i] = Sym(diagonal);
+				boundary_.erase(boundary_.begin() + j);
+				clipped = true;
+			}
+		}
+
+		if (!clipped)
+		{
+			// An open chain with no ears left is the new stretch of hull; a closed one should never get stuck
+			return !closed;
+		}
+	}
+}
+
+template <typename T>
+VertRef BasicDelaunay<T>::InsertPoint(T x, T y)
+{
+	Changed();
+
+	if (!built_)
+	{
+		// Nothing to edit yet; the build will sort it in
+		sorted_ = false;
+		return AddPoint(x, y);
+	}
+
+	VertType p(x, y);
+
+	if (LiveCount() < 3 || IsFlat())
+	{
+		// Too few points, or all in a line, to have triangles to walk through
+		// These are tiny or rare, so just check for a repeat and start over
+		for (std::size_t i = 0; i < vertices_.size(); i++)
+		{
+			const VertType& q = mesh_.vert(vertices_[i]);
+			if (!IsRemoved(vertices_[i]) && q.x() == x && q.y() == y)
+			{
+				return vertices_[i];
+			}
+		}
+
+		VertRef v = AddPoint(x, y);
+		sorted_ = false;
+		Rebuild();
+		return v;
+	}
+
+	EdgeRef e;
+	Location where = Locate(p, e);
+
+	if (where == ON_VERTEX)
+	{
+		lastEdge_ = e;
+		return mesh_.Org(e);
+	}
+
+	VertRef v = AddPoint(x, y);
+	sorted_ = false;
+
+	Attach(v, where, e);
+	return v;
+}
+
+template <typename T>
+void BasicDelaunay<T>::Attach(VertRef v, Location where, EdgeRef e)
+{
+	// Hook v into the triangulation wherever Locate found it; it has to be somewhere no other Vert is
+	const VertType& p = mesh_.vert(v);
+
+	if (where == IN_FACE)
+	{
+		// See if it landed right on one of the triangle's edges
+		EdgeRef f1 = mesh_.Lnext(e);
+		EdgeRef f2 = mesh_.Lnext(f1);
+		EdgeRef on = NIL;
+
+		if (Collinear(mesh_.origin(e), mesh_.destination(e), p))
+		{
+			on = e;
+		}
+		else if (Collinear(mesh_.origin(f1), mesh_.destination(f1), p))
+		{
+			on = f1;
+		}
+		else if (Collinear(mesh_.origin(f2), mesh_.destination(f2), p))
+		{
+			on = f2;
+		}
+
+		if (on == NIL)
+		{
+			FanInside(v, e);
+		}
+		else if (IsOutside(Sym(on)))
+		{
+			FanOutside(v, OpenHullEdge(on));
+		}
+		else
+		{
+			// Knock out the edge and fan out into the quadrilateral it leaves behind
+			e = mesh_.Oprev(on);
+			Kill(on, mesh_.arena());
+			FanInside(v, e);
+		}
+	}
+	else
+	{
+		// Strictly outside the hull edge e
+		FanOutside(v, e);
+	}
+
+	Legalize(v);
+	lastEdge_ = mesh_.edge(v);
+}
+
+template <typename T>
+bool BasicDelaunay<T>::RemovePoint(VertRef v)
+{
+	if (v >= mesh_.vertCount() || IsRemoved(v))
+	{
+		return false;
+	}
+
+	// Ask before v stops counting, or a line one point short looks like it has triangles
+	bool flat = IsFlat();
+
+	MarkRemoved(v);
+	Changed();
+
+	if (!built_)
+	{
+		// The build will skip it
+		return true;
+	}
+
+	if (LiveCount() < 3 || flat || mesh_.edge(v) == NIL || !Unlink(v))
+	{
+		// Nothing worth patching, or the hole wouldn't close; start over without it
+		Rebuild();
+	}
+
+	return true;
+}
+
+template <typename T>
+bool BasicDelaunay<T>::Unlink(VertRef v)
+{
+	// Gather the spokes around v, counterclockwise, and find the wedge that's outside the hull, if any
+	ring_.clear();
+	EdgeRef first = mesh_.edge(v);
+	EdgeRef e = first;
+	do
+	{
+		ring_.push_back(e);
+		e = mesh_.Onext(e);
+	} while (e != first);
+
+	std::size_t k = ring_.size();
+	std::size_t gap = k;
+
+	for (std::size_t i = 0; i < k; i++)
+	{
+		if (IsOutside(ring_[i]))
+		{
+			gap = i;
+			break;
+		}
+	}
+
+	// The far side of each triangle around v becomes the boundary of the hole, starting just past the outside wedge
+	boundary_.clear();
+	std::size_t start = (gap == k) ? 0 : gap + 1;
+
+	for (std::size_t j = 0; j < k; j++)
+	{
+		std::size_t i = (start + j) % k;
+		if (i != gap)
+		{
+			boundary_.push_back(mesh_.Lnext(ring_[i]));
+		}
+	}
+
+	for (std::size_t i = 0; i < k; i++)
+	{
+		Kill(ring_[i], mesh_.arena());
+	}
+
+	if (!ClipEars(gap == k))
+	{
+		// Shouldn't happen, but if the hole won't close there's always the slow way
+		return false;
+	}
+
+	lastEdge_ = boundary_[0];
+
+	return true;
+}
+
+template <typename T>
+VertRef BasicDelaunay<T>::MovePoint(VertRef v, T x, T y)
+{
+	if (v >= mesh_.vertCount() || IsRemoved(v))
+	{
+		return NIL;
+	}
+
+	const VertType& from = mesh_.vert(v);
+	if (from.x() == x && from.y() == y)
+	{
+		return v;
+	}
+
+	// vertices_ is only in order until something moves; the next rebuild puts it back
+	Changed();
+	sorted_ = false;
+
+	VertType to(x, y);
+
+	if (!built_)
+	{
+		mesh_.setVert(v, x, y);
+		return v;
+	}
+
+	if (LiveCount() <= 3 || IsFlat())
+	{
+		// Same as inserting into something this small: check for a repeat and start over
+		for (std::size_t i = 0; i < vertices_.size(); i++)
+		{
+			const VertType& q = mesh_.vert(vertices_[i]);
+			if (vertices_[i] != v && !IsRemoved(vertices_[i]) && q.x() == x && q.y() == y)
+			{
+				MarkRemoved(v);
+				Rebuild();
+				return vertices_[i];
+			}
+		}
+
+		mesh_.setVert(v, x, y);
+		Rebuild();
+		return v;
+	}
+
+	// Most moves are short hops that stay inside the triangles around v
+	if (Slide(v, to))
+	{
+		lastEdge_ = mesh_.edge(v);
+		return v;
+	}
+
+	// Otherwise take v out and put it back; look first, in case somebody's already there
+	lastEdge_ = mesh_.edge(v);
+
+	EdgeRef e;
+	if (Locate(to, e) == ON_VERTEX)
+	{
+		VertRef there = mesh_.Org(e);
+		RemovePoint(v);
+		return there;
+	}
+
+	if (!Unlink(v) || mesh_.quadCount() + 2 == LiveCount())
+	{
+		// The hole wouldn't close, or v was the only thing keeping the rest off a line
+		mesh_.setVert(v, x, y);
+		Rebuild();
+		return v;
+	}
+
+	mesh_.setVert(v, x, y);
+	Location where = Locate(to, e);
+	Attach(v, where, e);
+
+	return v;
+}
+
+template <typename T>
+bool BasicDelaunay<T>::Slide(VertRef v, const VertType& to)
+{
+	// If v is inside the hull and lands strictly inside the polygon around it, every triangle around v stays counterclockwise
+	// Then only the triangles touching v have new circles, so their edges are the only ones that can need flipping
+	ring_.clear();
+	EdgeRef first = mesh_.edge(v);
+	EdgeRef e = first;
+	do
+	{
+		if (IsOutside(e) || !LeftOf(mesh_, mesh_.Lnext(e), to))
+		{
+			return false;
+		}
+
+		ring_.push_back(e);
+		e = mesh_.Onext(e);
+	} while (e != first);
+
+	mesh_.setVert(v, to.x(), to.y());
+
+	for (std::size_t i = 0; i < ring_.size(); i++)
+	{
+		suspects_.push_back(ring_[i]);
+		suspects_.push_back(mesh_.Lnext(ring_[i]));
+	}
+
+	Relax();
+	return true;
+}
+
+template <typename T>
+void BasicDelaunay<T>::Relax()
+{
+	// Lawson's flip algorithm on the suspects: any edge whose far corner is inside the circle on its near side gets flipped,
+	// and the four edges around it become suspects in turn
+	// The tie-break makes every four points decide one way, so this ends up on the same triangulation a rebuild would
+	while (!suspects_.empty())
+	{
+		EdgeRef e = suspects_.back();
+		suspects_.pop_back();
+
+		if (IsOutside(e) || IsOutside(Sym(e)))
+		{
+			continue;
+		}
+
+		EdgeRef left = mesh_.Lnext(e);
+		EdgeRef right = mesh_.Lnext(Sym(e));
+
+		if (InCircle(mesh_.origin(e), mesh_.destination(e), mesh_.destination(left), mesh_.destination(right)))
+		{
+			suspects_.push_back(left);
+			suspects_.push_back(mesh_.Lnext(left));
+			suspects_.push_back(right);
+			suspects_.push_back(mesh_.Lnext(right));
+			mesh_.Swap(e);
+		}
+	}
+}
+
+template <typename T>
+void BasicDelaunay<T>::GetNeighborhood(VertRef v, T radius, PointsList& out)
+{
+	out.clear();
+
+	if (!built_)
+	{
+		Build();
+	}
+
+	if (v >= mesh_.vertCount() || IsRemoved(v) || mesh_.edge(v) == NIL)
+	{
+		return;
+	}
+
+	// A plain flood is enough here, since everything in range gets visited no matter the order
+	const VertType& center = mesh_.vert(v);
+	std::uint64_t reach = DistanceKey(center.x(), center.y(), (T)(center.x() + radius), center.y());
+
+	seen_.resize(mesh_.vertCount(), false);
+	seen_[v] = true;
+	touched_.push_back(v);
+
+	frontier_.clear();
+	RadixItem start = { 0, v };
+	frontier_.push_back(start);
+
+	while (!frontier_.empty())
+	{
+		VertRef u = frontier_.back().index;
+		frontier_.pop_back();
+
+		EdgeRef first = mesh_.edge(u);
+		EdgeRef f = first;
+		do
+		{
+			VertRef w = mesh_.Dest(f);
+			if (!seen_[w])
+			{
+				seen_[w] = true;
+				touched_.push_back(w);
+
+				const VertType& pw = mesh_.vert(w);
+				std::uint64_t key = DistanceKey(pw.x(), pw.y(), center.x(), center.y());
+
+				if (key <= reach)
+				{
+					out.push_back(w);
+					RadixItem next = { key, w };
+					frontier_.push_back(next);
+				}
+			}
+			f = mesh_.Onext(f);
+		} while (f != first);
+	}
+
+	for (std::size_t i = 0; i < touched_.size(); i++)
+	{
+		seen_[touched_[i]] = false;
+	}
+	touched_.clear();
+}
+
+template <typename T>
+void BasicDelaunay<T>::Export(TriangulationExport& out)
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	std::uint32_t n = mesh_.vertCount();
+	out.offsets.resize(n + 1);
+	out.neighbors.clear();
+	out.neighbors.reserve(mesh_.quadCount() * 2);
+	out.triangles.clear();
+	out.triangles.reserve(mesh_.quadCount() * 2);
+	out.hull.clear();
+
+	EdgeRef outside = NIL;
+
+	for (VertRef v = 0; v < n; v++)
+	{
+		out.offsets[v] = out.neighbors.size();
+
+		EdgeRef first = mesh_.edge(v);
+		if (IsRemoved(v) || first == NIL)
+		{
+			continue;
+		}
+
+		EdgeRef e = first;
+		do
+		{
+			out.neighbors.push_back(mesh_.Dest(e));
+
+			// Each triangle gets written by its lowest Vert, so only that one pays for the orientation test
+			// Anything on the left that isn't a counterclockwise triangle is the outside
+			EdgeRef f1 = mesh_.Lnext(e);
+			EdgeRef f2 = mesh_.Lnext(f1);
+
+			if (mesh_.Lnext(f2) != e)
+			{
+				outside = e;
+			}
+			else if (v < mesh_.Org(f1) && v < mesh_.Org(f2))
+			{
+				if (CCW(mesh_.origin(e), mesh_.destination(e), mesh_.destination(f1)))
+				{
+					out.triangles.push_back(v);
+					out.triangles.push_back(mesh_.Org(f1));
+					out.triangles.push_back(mesh_.Org(f2));
+				}
+				else
+				{
+					outside = e;
+				}
+			}
+
+			e = mesh_.Onext(e);
+		} while (e != first);
+	}
+
+	out.offsets[n] = out.neighbors.size();
+
+	// The outside runs clockwise, so walk it and turn it around
+	if (outside != NIL)
+	{
+		EdgeRef e = outside;
+		do
+		{
+			out.hull.push_back(mesh_.Org(e));
+			e = mesh_.Lnext(e);
+		} while (e != outside);
+
+		std::reverse(out.hull.begin(), out.hull.end());
+	}
+}
+
+template <typename T>
+EdgeList BasicDelaunay<T>::GetVoronoi()
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	if (!facesBuilt_)
+	{
+		BuildFaces();
+	}
+
+	return voronoi_;
+}
+
+template <typename T>
+const VoronoiCells& BasicDelaunay<T>::GetVoronoiCells()
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	if (!facesBuilt_)
+	{
+		BuildFaces();
+	}
+
+	if (!cellsBuilt_)
+	{
+		BuildCells();
+	}
+
+	return cells_;
+}
+
+template <typename T>
+EdgeList BasicDelaunay<T>::GetMST(MSTMethod method)
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	EdgeList mst;
+	mst.reserve(LiveCount());
+
+	if (method == PRIM_MST)
+	{
+		PrimMST(mst);
+	}
+	else
+	{
+		KruskalMST(mst);
+	}
+
+	return mst;
+}
+
+template <typename T>
+EdgeList BasicDelaunay<T>::GetGabriel()
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	EdgeList gabriel;
+
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q) && IsGabriel(q * 4))
+		{
+			gabriel.push_back(q * 4);
+		}
+	}
+
+	return gabriel;
+}
+
+template <typename T>
+EdgeList BasicDelaunay<T>::GetRelativeNeighbors()
+{
+	if (!built_)
+	{
+		Build();
+	}
+
+	EdgeList rng;
+	seen_.resize(mesh_.vertCount(), false);
+
+	// The lune holds the circle, so only Gabriel edges need the full search
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q) && IsGabriel(q * 4) && LuneEmpty(q * 4))
+		{
+			rng.push_back(q * 4);
+		}
+	}
+
+	return rng;
+}
+
+//	--------------------------------------------------------
+//	Proximity graph helpers
+//	--------------------------------------------------------
+
+template <typename T>
+bool BasicDelaunay<T>::IsGabriel(EdgeRef e) const
+{
+	// Any point inside the circle would keep e from being Delaunay unless it's one of the two corners across from e
+	const VertType& a = mesh_.origin(e);
+	const VertType& b = mesh_.destination(e);
+	EdgeRef left = mesh_.Onext(e);
+	EdgeRef right = mesh_.Oprev(e);
+
+	if (LeftOf(mesh_, e, mesh_.destination(left)) && InDiametralCircle(a, b, mesh_.destination(left)))
+	{
+		return false;
+	}
+	if (RightOf(mesh_, e, mesh_.destination(right)) && InDiametralCircle(a, b, mesh_.destination(right)))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+template <typename T>
+bool BasicDelaunay<T>::LuneEmpty(EdgeRef e)
+{
+	// The lune isn't bounded by anything the triangulation knows about, so the corners across from e aren't enough
+	// Instead, visit Verts outward from a in order of distance until we're |ab| away
+	// Everything closer to a than that is connected to a through other Verts that are closer still, so nobody gets skipped
+	VertRef a = mesh_.Org(e);
+	VertRef b = mesh_.Dest(e);
+	const VertType& pa = mesh_.vert(a);
+	const VertType& pb = mesh_.vert(b);
+	std::uint64_t reach = DistanceKey(pa.x(), pa.y(), pb.x(), pb.y());
+
+	// The corners across from e are the usual culprits, so try them before searching
+	VertRef corners[2] = { mesh_.Dest(mesh_.Onext(e)), mesh_.Dest(mesh_.Oprev(e)) };
+	for (int i = 0; i < 2; i++)
+	{
+		const VertType& pc = mesh_.vert(corners[i]);
+		if (corners[i] != b && DistanceKey(pc.x(), pc.y(), pa.x(), pa.y()) < reach && DistanceKey(pc.x(), pc.y(), pb.x(), pb.y()) < reach)
+		{
+			return false;
+		}
+	}
+
+	auto further = [](const RadixItem& x, const RadixItem& y) { return x.key > y.key; };
+	bool empty = true;
+
+	frontier_.clear();
+	RadixItem start = { 0, a };
+	frontier_.push_back(start);
+	seen_[a] = true;
+	touched_.push_back(a);
+
+	while (!frontier_.empty())
+	{
+		std::pop_heap(frontier_.begin(), frontier_.end(), further);
+		RadixItem item = frontier_.back();
+		frontier_.pop_back();
+
+		if (item.key >= reach)
+		{
+			break;
+		}
+
+		const VertType& pv = mesh_.vert(item.index);
+		if (item.index != a && DistanceKey(pv.x(), pv.y(), pb.x(), pb.y()) < reach)
+		{
+			empty = false;
+			break;
+		}
+
+		EdgeRef first = mesh_.edge(item.index);
+		EdgeRef f = first;
+		do
+		{
+			VertRef w = mesh_.Dest(f);
+			if (!seen_[w])
+			{
+				seen_[w] = true;
+				touched_.push_back(w);
+
+				const VertType& pw = mesh_.vert(w);
+				RadixItem next = { DistanceKey(pw.x(), pw.y(), pa.x(), pa.y()), w };
+				frontier_.push_back(next);
+				std::push_heap(frontier_.begin(), frontier_.end(), further);
+			}
+			f = mesh_.Onext(f);
+		} while (f != first);
+	}
+
+	for (std::size_t i = 0; i < touched_.size(); i++)
+	{
+		seen_[touched_[i]] = false;
+	}
+	touched_.clear();
+
+	return empty;
+}
+
+//	--------------------------------------------------------
+//	Voronoi helpers
+//	--------------------------------------------------------
+
+template <typename T>
+void BasicDelaunay<T>::BuildFaces()
+{
+	// Wipe the old labels; the left face of every primal edge is the origin of its InvRot
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q))
+		{
+			mesh_.setDualOrigin(Rot(q * 4), NIL);
+			mesh_.setDualOrigin(InvRot(q * 4), NIL);
+		}
+	}
+
+	// Walk each directed edge, and the first one to find an unnumbered triangle on its left numbers it for all three
+	// The outside of the hull runs clockwise, so the orientation test keeps it out even when it's three edges long
+	triangles_.clear();
+
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (!mesh_.IsLive(q))
+		{
+			continue;
+		}
+
+		for (EdgeRef e = q * 4; e < q * 4 + 4; e += 2)
+		{
+			if (mesh_.Left(e) != NIL)
+			{
+				continue;
+			}
+
+			EdgeRef f1 = mesh_.Lnext(e);
+			EdgeRef f2 = mesh_.Lnext(f1);
+
+			if (mesh_.Lnext(f2) != e || !CCW(mesh_.origin(e), mesh_.destination(e), mesh_.destination(f1)))
+			{
+				continue;
+			}
+
+			std::uint32_t f = triangles_.size() / 3;
+			mesh_.setDualOrigin(InvRot(e), f);
+			mesh_.setDualOrigin(InvRot(f1), f);
+			mesh_.setDualOrigin(InvRot(f2), f);
+
+			triangles_.push_back(mesh_.Org(e));
+			triangles_.push_back(mesh_.Org(f1));
+			triangles_.push_back(mesh_.Org(f2));
+		}
+	}
+
+	// Now every circumcenter, straight down the array, once each
+	std::uint32_t faces = triangles_.size() / 3;
+	mesh_.ClearFaces(faces);
+
+	for (std::uint32_t f = 0; f < faces; f++)
+	{
+		const VertRef* t = &triangles_[f * 3];
+		Vert c = Circumcenter(mesh_.vert(t[0]), mesh_.vert(t[1]), mesh_.vert(t[2]));
+		mesh_.AddFace(c.x(), c.y());
+	}
+
+	// The Voronoi edges are the duals with a face at both ends
+	voronoi_.clear();
+
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q) && mesh_.Left(q * 4) != NIL && mesh_.Right(q * 4) != NIL)
+		{
+			voronoi_.push_back(Rot(q * 4));
+		}
+	}
+
+	facesBuilt_ = true;
+}
+
+template <typename T>
+void BasicDelaunay<T>::BuildCells()
+{
+	// The faces around a Vert are the left faces of its spokes, in Onext order
+	std::uint32_t n = mesh_.vertCount();
+	cells_.offsets.resize(n + 1);
+	cells_.faces.clear();
+	cells_.faces.reserve(triangles_.size() + n);
+
+	for (VertRef v = 0; v < n; v++)
+	{
+		cells_.offsets[v] = cells_.faces.size();
+
+		EdgeRef first = mesh_.edge(v);
+		if (IsRemoved(v) || first == NIL)
+		{
+			continue;
+		}
+
+		// On the hull, start just past the open side so the NIL comes last
+		EdgeRef e = first;
+		do
+		{
+			if (mesh_.Left(e) == NIL)
+			{
+				first = mesh_.Onext(e);
+				break;
+			}
+			e = mesh_.Onext(e);
+		} while (e != first);
+
+		e = first;
+		do
+		{
+			cells_.faces.push_back(mesh_.Left(e));
+			e = mesh_.Onext(e);
+		} while (e != first);
+	}
+
+	cells_.offsets[n] = cells_.faces.size();
+	cellsBuilt_ = true;
+}
+
+//	--------------------------------------------------------
+//	Spanning tree helpers
+//	--------------------------------------------------------
+
+template <typename T>
+std::uint64_t BasicDelaunay<T>::WeightKey(EdgeRef e) const
+{
+	const VertType& a = mesh_.origin(e);
+	const VertType& b = mesh_.destination(e);
+	return DistanceKey(a.x(), a.y(), b.x(), b.y());
+}
+
+template <typename T>
+void BasicDelaunay<T>::KruskalMST(EdgeList& mst)
+{
+	// Sort every edge by length in linear time, then take each one that joins two different pieces
+	sortItems_.clear();
+
+	for (std::uint32_t q = 0; q < mesh_.quadCapacity(); q++)
+	{
+		if (mesh_.IsLive(q))
+		{
+			RadixItem item = { WeightKey(q * 4), q };
+			sortItems_.push_back(item);
+		}
+	}
+
+	RadixSort(sortItems_, sortScratch_);
+
+	sets_.Reset(mesh_.vertCount());
+	std::size_t wanted = (LiveCount() > 0) ? LiveCount() - 1 : 0;
+
+	for (std::size_t i = 0; i < sortItems_.size() && mst.size() < wanted; i++)
+	{
+		EdgeRef e = sortItems_[i].index * 4;
+		if (sets_.Union(mesh_.Org(e), mesh_.Dest(e)))
+		{
+			mst.push_back(e);
+		}
+	}
+}
+
+template <typename T>
+void BasicDelaunay<T>::PrimMST(EdgeList& mst)
+{
+	// Grow a tree from each piece in turn, always pulling in the closest Vert not in it yet
+	std::uint32_t n = mesh_.vertCount();
+	heap_.Reset(n);
+	via_.assign(n, NIL);
+	inTree_.assign(n, false);
+
+	for (std::size_t i = 0; i < vertices_.size(); i++)
+	{
+		VertRef root = vertices_[i];
+
+		if (IsRemoved(root) || inTree_[root] || mesh_.edge(root) == NIL)
+		{
+			continue;
+		}
+
+		heap_.Push(root, 0);
+
+		while (!heap_.empty())
+		{
+			VertRef v = heap_.Pop();
+			inTree_[v] = true;
+
+			if (via_[v] != NIL)
+			{
+				mst.push_back(via_[v]);
+			}
+
+			// Offer every neighbor the edge from here, and remember it if it's their best so far
+			EdgeRef first = mesh_.edge(v);
+			EdgeRef e = first;
+			do
+			{
+				VertRef w = mesh_.Dest(e);
+				if (!inTree_[w] && heap_.Push(w, WeightKey(e)))
+				{
+					via_[w] = e;
+				}
+				e = mesh_.Onext(e);
+			} while (e != first);
+		}
+	}
 }
 
 //	--------------------------------------------------------
 
-#endif
\ No newline at end of file
+#endif